@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <unistd.h>
+
+#include "../include/core/Cache.h"
+#include "../include/core/Utils.h"
+
+// entries read or written are kept in memory, so a compile server serves repeated hits without reading them again
+static std::map<std::string, std::string> warm_units = {};
+static std::uintmax_t warm_size = 0;
+
+/// Keeps an entry in memory, forgetting all others once they outgrow the given limit.
+static void warm_unit(const std::string &key, const std::string &unit, std::uintmax_t limit) {
+  if (warm_size + unit.size() > limit) {
+    warm_units.clear();
+    warm_size = 0;
+  }
+
+  if (warm_units.emplace(key, unit).second) {
+    warm_size += unit.size();
+  }
+}
+
+
+/// Hashes a string with 64-bit FNV-1a, continuing from a previous hash.
+static std::uint64_t hash_str(const std::string &s, std::uint64_t h = 0xcbf29ce484222325ull) {
+  for (const unsigned char c : s) {
+    h = (h ^ c) * 0x100000001b3ull;
+  }
+  return (h ^ 0xff) * 0x100000001b3ull;  // separate consecutive strings
+}
+
+
+/// Returns a hash as a fixed width hex string.
+static std::string hash_to_hex(std::uint64_t h) {
+  static const char *digits = "0123456789abcdef";
+  std::string result(16, '0');
+  for (int i = 15; i >= 0; i--, h >>= 4) {
+    result[i] = digits[h & 0xf];
+  }
+  return result;
+}
+
+
+/// Returns a string identifying this build of the compiler, from the size and modification time of its executable.
+static std::string compiler_build(void) {
+  std::error_code ec;
+  const std::filesystem::path exe = std::filesystem::read_symlink("/proc/self/exe", ec);
+  if (ec) {
+    return "statimc";
+  }
+
+  const std::uintmax_t size = std::filesystem::file_size(exe, ec);
+  const auto mtime = std::filesystem::last_write_time(exe, ec).time_since_epoch().count();
+  return "statimc " + std::to_string(size) + " " + std::to_string(mtime);
+}
+
+
+BuildCache::BuildCache() {
+  if (const char *xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+    dir = std::filesystem::path(xdg) / "statimc";
+  } else if (const char *home = std::getenv("HOME"); home && *home) {
+    dir = std::filesystem::path(home) / ".cache" / "statimc";
+  } else {
+    dir = std::filesystem::temp_directory_path() / "statimc";
+  }
+}
+
+
+void BuildCache::add_packages(const std::vector<struct CFile> &files, const struct CFlags &flags) {
+  std::map<std::string, std::string> sources;
+  for (const struct CFile &file : files) {
+    sources[remove_extension(file.filename)] = file.src ? *file.src : read_to_str(file.path);
+  }
+
+  std::string base = compiler_build() + (flags.lto ? " -flto" : "");
+  if (flags.lto) {
+    // link-time optimization looks at every package of the crate
+    for (const auto &[name, src] : sources) {
+      base += hash_to_hex(hash_str(src, hash_str(name)));
+    }
+  }
+
+  // keys of imports are folded into the key of each package, so a key covers its whole import tree
+  std::vector<std::string> visiting;
+  const auto get_key = [&](const auto &self, const std::string &name) -> std::string {
+    if (keys.find(name) != keys.end()) {
+      return keys.at(name);
+    } else if (sources.find(name) == sources.end() || \
+        std::find(visiting.begin(), visiting.end(), name) != visiting.end()) {
+      return name;
+    }
+
+    visiting.push_back(name);
+    std::uint64_t h = hash_str(sources.at(name), hash_str(name, hash_str(base)));
+    std::vector<std::string> imports = scan_imports(sources.at(name));
+    std::sort(imports.begin(), imports.end());
+    for (const std::string &import : imports) {
+      h = hash_str(self(self, import), h);
+    }
+    visiting.pop_back();
+
+    keys[name] = hash_to_hex(h);
+    return keys.at(name);
+  };
+
+  for (const auto &[name, src] : sources) {
+    get_key(get_key, name);
+  }
+}
+
+
+bool BuildCache::load(const std::string &pkg, std::string &unit) const {
+  if (keys.find(pkg) == keys.end()) {
+    return false;
+  }
+
+  const std::string &key = keys.at(pkg);
+  if (warm_units.find(key) != warm_units.end()) {
+    unit = warm_units.at(key);
+    return true;
+  }
+
+  const std::filesystem::path entry = dir / key;
+  std::error_code ec;
+  if (!std::filesystem::is_regular_file(entry, ec)) {
+    return false;
+  }
+
+  unit = read_to_str(entry.string());
+  warm_unit(key, unit, limit());
+
+  // hits are marked as recently used, so pruning keeps them
+  std::filesystem::last_write_time(entry, std::filesystem::file_time_type::clock::now(), ec);
+  return true;
+}
+
+
+void BuildCache::store(const std::string &pkg, const std::string &unit) const {
+  if (keys.find(pkg) == keys.end()) {
+    return;
+  }
+
+  // entries are written under a temporary name and renamed, so concurrent builds never read a partial entry
+  std::error_code ec;
+  std::filesystem::create_directories(dir, ec);
+  const std::filesystem::path entry = dir / keys.at(pkg);
+  const std::filesystem::path tmp = dir / (keys.at(pkg) + ".tmp" + std::to_string(getpid()));
+  {
+    std::ofstream out(tmp, std::ios::binary);
+    if (!out.is_open()) {
+      return;
+    }
+    out << unit;
+  }
+  std::filesystem::rename(tmp, entry, ec);
+  if (ec) {
+    std::filesystem::remove(tmp, ec);
+  }
+
+  warm_unit(keys.at(pkg), unit, limit());
+  if (size() > limit()) {
+    prune(limit());
+  }
+}
+
+
+std::size_t BuildCache::count() const {
+  std::error_code ec;
+  std::size_t n = 0;
+  for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(dir, ec)) {
+    n += entry.is_regular_file() ? 1 : 0;
+  }
+  return n;
+}
+
+
+std::uintmax_t BuildCache::size() const {
+  std::error_code ec;
+  std::uintmax_t total = 0;
+  for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(dir, ec)) {
+    total += entry.is_regular_file() ? entry.file_size() : 0;
+  }
+  return total;
+}
+
+
+std::uintmax_t BuildCache::limit() const {
+  const char *limit = std::getenv("STATIMC_CACHE_LIMIT");
+  if (!limit || !*limit || std::string(limit).find_first_not_of("0123456789") != std::string::npos) {
+    return default_limit;
+  }
+
+  try {
+    return std::stoull(limit);
+  } catch (const std::out_of_range &) {
+    return default_limit;
+  }
+}
+
+
+std::size_t BuildCache::prune(std::uintmax_t max_size) const {
+  std::error_code ec;
+  std::vector<std::filesystem::directory_entry> entries;
+  std::uintmax_t total = 0;
+  for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(dir, ec)) {
+    if (entry.is_regular_file()) {
+      entries.push_back(entry);
+      total += entry.file_size();
+    }
+  }
+
+  // least recently used entries go first
+  std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) {
+    return a.last_write_time() < b.last_write_time();
+  });
+
+  std::size_t removed = 0;
+  for (const std::filesystem::directory_entry &entry : entries) {
+    if (total <= max_size) {
+      break;
+    }
+
+    total -= entry.file_size();
+    if (std::filesystem::remove(entry.path(), ec)) {
+      removed++;
+    }
+  }
+  return removed;
+}
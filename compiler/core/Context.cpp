@@ -3,14 +3,46 @@
 #include "../include/core/Utils.h"
 
 ASTContext::ASTContext(struct CFlags flags, std::vector<struct CFile> input)
-: flags(flags), input(input), _last(Token(Eof)), _last_two(Token(Eof)), _add_next_to_scope(true), _top_impl(""), type_table({}) {
+: flags(flags), input(input), _last(Token(Eof)), _last_two(Token(Eof)), _add_next_to_scope(true), _top_impl(""), type_table({}), str_pool({}) {
   // load built-in types
   type_table["bool"] = new PrimitiveType(PrimitiveType::__UINT1);
-  type_table["uint"] = new PrimitiveType(PrimitiveType::__UINT32);
+  type_table["i8"] = new PrimitiveType(PrimitiveType::__INT8);
+  type_table["u8"] = new PrimitiveType(PrimitiveType::__UINT8);
+  type_table["i16"] = new PrimitiveType(PrimitiveType::__INT16);
+  type_table["u16"] = new PrimitiveType(PrimitiveType::__UINT16);
   type_table["i32"] = new PrimitiveType(PrimitiveType::__INT32);
+  type_table["u32"] = new PrimitiveType(PrimitiveType::__UINT32);
   type_table["i64"] = new PrimitiveType(PrimitiveType::__INT64);
-  type_table["float"] = new PrimitiveType(PrimitiveType::__FP32);
+  type_table["u64"] = new PrimitiveType(PrimitiveType::__UINT64);
+  type_table["f32"] = new PrimitiveType(PrimitiveType::__FP32);
+  type_table["f64"] = new PrimitiveType(PrimitiveType::__FP64);
   type_table["char"] = new PrimitiveType(PrimitiveType::__CHAR);
+  type_table["str"] = new PrimitiveType(PrimitiveType::__STR);
+
+  // `uint` and `float` are the legacy spellings of `u32` and `f32`
+  type_table["uint"] = type_table.at("u32");
+  type_table["float"] = type_table.at("f32");
+
+  // load built-in vector types
+  const PrimitiveType *f32 = static_cast<const PrimitiveType *>(type_table.at("f32"));
+  const PrimitiveType *i32 = static_cast<const PrimitiveType *>(type_table.at("i32"));
+  const PrimitiveType *i64 = static_cast<const PrimitiveType *>(type_table.at("i64"));
+  const PrimitiveType *u8 = static_cast<const PrimitiveType *>(type_table.at("u8"));
+  type_table["m8x16"] = new VectorType(8, 16);
+  type_table["m32x4"] = new VectorType(32, 4);
+  type_table["m32x8"] = new VectorType(32, 8);
+  type_table["m64x2"] = new VectorType(64, 2);
+  type_table["f32x4"] = new VectorType(f32, 4, static_cast<const VectorType *>(type_table.at("m32x4")));
+  type_table["f32x8"] = new VectorType(f32, 8, static_cast<const VectorType *>(type_table.at("m32x8")));
+  type_table["i32x4"] = new VectorType(i32, 4, static_cast<const VectorType *>(type_table.at("m32x4")));
+  type_table["i32x8"] = new VectorType(i32, 8, static_cast<const VectorType *>(type_table.at("m32x8")));
+  type_table["i64x2"] = new VectorType(i64, 2, static_cast<const VectorType *>(type_table.at("m64x2")));
+  type_table["u8x16"] = new VectorType(u8, 16, static_cast<const VectorType *>(type_table.at("m8x16")));
+
+  // memory orderings of atomic operations, and access hints of mapped files
+  type_table["Ordering"] = new EnumType("Ordering");
+  type_table["Advice"] = new EnumType("Advice");
+  type_table["MappedFile"] = new MappedFileType();
 }
 
 
@@ -22,7 +54,8 @@ struct Token ASTContext::next(void) {
 
 void ASTContext::next_file(void) {
   if (input.size() != 0) {
-      std::string f_src = read_to_str(input.at(input.size() - 1).path);
+      const struct CFile &file = input.at(input.size() - 1);
+      std::string f_src = file.src ? *file.src : read_to_str(file.path);
       _file = input.at(input.size() - 1).filename;
       lexer = std::make_unique<Tokenizer>(f_src, input.at(input.size() - 1).filename, f_src.size());
       next();
@@ -58,3 +91,86 @@ Type* ASTContext::resolve_type(const std::string &name) {
   type_table[name] = new TypeRef(name);
   return type_table.at(name);
 }
+
+
+Type* ASTContext::resolve_generic_type(const std::string &name, const std::vector<const Type *> &params) {
+  std::string key = name + '<';
+  for (std::size_t i = 0; i < params.size(); i++) {
+    key += i == 0 ? "" : ", ";
+    key += params.at(i) ? params.at(i)->to_string() : "void";
+  }
+  key += '>';
+
+  if (type_table.find(key) != type_table.end()) {
+    return type_table.at(key);
+  }
+
+  Type *T = nullptr;
+  if (name == "task" && params.size() == 1) {
+    T = new TaskType(params.at(0));
+  } else if (name == "Vec" && params.size() == 1 && params.at(0)) {
+    T = new VecType(params.at(0));
+  } else if (name == "Map" && params.size() == 2 && params.at(0) && params.at(1)) {
+    T = new MapType(params.at(0), params.at(1));
+  } else if (name == "atomic" && params.size() == 1) {
+    // atomics are limited to values which fit a single lock-prefixed instruction
+    const PrimitiveType *pt = dynamic_cast<const PrimitiveType *>(params.at(0));
+    if (dynamic_cast<const RuneType *>(params.at(0)) || (pt && (pt->get_kind() == PrimitiveType::__INT32 || \
+        pt->get_kind() == PrimitiveType::__INT64 || pt->get_kind() == PrimitiveType::__UINT32 || \
+        pt->get_kind() == PrimitiveType::__UINT64 || pt->get_kind() == PrimitiveType::__UINT1))) {
+      T = new AtomicType(params.at(0));
+    }
+  }
+
+  if (T) {
+    type_table[key] = T;
+  }
+  return T;
+}
+
+
+Type* ASTContext::resolve_array_type(const Type *T, unsigned int len) {
+  const std::string key = "[" + T->to_string() + "; " + std::to_string(len) + "]";
+  if (type_table.find(key) == type_table.end()) {
+    type_table[key] = new ArrayType(len, T);
+  }
+  return type_table.at(key);
+}
+
+
+Type* ASTContext::resolve_chan_type(const Type *T, unsigned int cap) {
+  const std::string key = "chan<" + T->to_string() + "; " + std::to_string(cap) + ">";
+  if (type_table.find(key) == type_table.end()) {
+    type_table[key] = new ChanType(cap, T);
+  }
+  return type_table.at(key);
+}
+
+
+Type* ASTContext::resolve_rune_type(const Type *T) {
+  const std::string key = "#" + T->to_string();
+  if (type_table.find(key) == type_table.end()) {
+    type_table[key] = new RuneType(T);
+  }
+  return type_table.at(key);
+}
+
+
+Type* ASTContext::resolve_slice_type(const Type *T) {
+  const std::string key = "[" + T->to_string() + "]";
+  if (type_table.find(key) == type_table.end()) {
+    type_table[key] = new SliceType(T);
+  }
+  return type_table.at(key);
+}
+
+
+unsigned int ASTContext::intern_str(const std::string &value) {
+  if (str_pool.find(value) != str_pool.end()) {
+    return str_pool.at(value);
+  }
+
+  const unsigned int id = str_pool.size();
+  str_pool[value] = id;
+  return id;
+}
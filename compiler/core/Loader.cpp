@@ -0,0 +1,333 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+
+#include "../include/core/Loader.h"
+
+/// The number of submission queue entries, which also bounds the operations in flight.
+static constexpr unsigned int ring_entries = 256;
+
+/// Ring - The submission and completion queues of an io_uring instance, mapped from the kernel.
+struct Ring {
+  int fd = -1;
+  unsigned int entries = 0;
+  void *sq_ptr = MAP_FAILED;
+  void *cq_ptr = MAP_FAILED;
+  std::size_t sq_len = 0;
+  std::size_t cq_len = 0;
+  io_uring_sqe *sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+  unsigned int *sq_head, *sq_tail, *sq_mask, *sq_array;
+  unsigned int *cq_head, *cq_tail, *cq_mask;
+  io_uring_cqe *cqes;
+  unsigned int unsubmitted = 0;
+};
+
+
+/// Unmaps and closes a ring.
+static void close_ring(Ring &ring) {
+  if (ring.sqes != MAP_FAILED) {
+    munmap(ring.sqes, ring.entries * sizeof(io_uring_sqe));
+  }
+  if (ring.cq_ptr != MAP_FAILED && ring.cq_ptr != ring.sq_ptr) {
+    munmap(ring.cq_ptr, ring.cq_len);
+  }
+  if (ring.sq_ptr != MAP_FAILED) {
+    munmap(ring.sq_ptr, ring.sq_len);
+  }
+  if (ring.fd >= 0) {
+    close(ring.fd);
+  }
+}
+
+
+/// Sets up a ring and maps its queues.
+/// @returns `false` if io_uring is unavailable.
+static bool open_ring(Ring &ring) {
+  io_uring_params params = {};
+  ring.fd = syscall(__NR_io_uring_setup, ring_entries, &params);
+  if (ring.fd < 0) {
+    return false;
+  }
+  ring.entries = params.sq_entries;
+
+  // kernels with a single mapping share it between both queues
+  ring.sq_len = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+  ring.cq_len = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap) {
+    ring.sq_len = ring.cq_len = std::max(ring.sq_len, ring.cq_len);
+  }
+
+  ring.sq_ptr = mmap(nullptr, ring.sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQ_RING);
+  ring.cq_ptr = single_mmap ? ring.sq_ptr : \
+    mmap(nullptr, ring.cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_CQ_RING);
+  ring.sqes = static_cast<io_uring_sqe *>(mmap(nullptr, ring.entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE,
+    MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQES));
+  if (ring.sq_ptr == MAP_FAILED || ring.cq_ptr == MAP_FAILED || ring.sqes == MAP_FAILED) {
+    close_ring(ring);
+    return false;
+  }
+
+  char *sq = static_cast<char *>(ring.sq_ptr);
+  ring.sq_head = reinterpret_cast<unsigned int *>(sq + params.sq_off.head);
+  ring.sq_tail = reinterpret_cast<unsigned int *>(sq + params.sq_off.tail);
+  ring.sq_mask = reinterpret_cast<unsigned int *>(sq + params.sq_off.ring_mask);
+  ring.sq_array = reinterpret_cast<unsigned int *>(sq + params.sq_off.array);
+
+  char *cq = static_cast<char *>(ring.cq_ptr);
+  ring.cq_head = reinterpret_cast<unsigned int *>(cq + params.cq_off.head);
+  ring.cq_tail = reinterpret_cast<unsigned int *>(cq + params.cq_off.tail);
+  ring.cq_mask = reinterpret_cast<unsigned int *>(cq + params.cq_off.ring_mask);
+  ring.cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+  return true;
+}
+
+
+/// Returns a cleared submission queue entry to fill in. Callers keep the operations in flight below the ring size,
+/// so there is always one free.
+static io_uring_sqe *get_sqe(Ring &ring) {
+  const unsigned int tail = *ring.sq_tail;
+  const unsigned int index = tail & *ring.sq_mask;
+  io_uring_sqe *sqe = &ring.sqes[index];
+  std::memset(sqe, 0, sizeof(io_uring_sqe));
+  ring.sq_array[index] = index;
+  __atomic_store_n(ring.sq_tail, tail + 1, __ATOMIC_RELEASE);
+  ring.unsubmitted++;
+  return sqe;
+}
+
+
+/// The steps of loading a file, kept in the low bits of the user data of each operation.
+enum LoadOp : std::uint64_t {
+  OpOpen = 0,
+  OpStat = 1,
+  OpRead = 2,
+  OpClose = 3,
+};
+
+/// LoadState - The progress of a file being loaded through a ring.
+struct LoadState {
+  int fd = -1;
+  int pending = 0;
+  bool failed = false;
+  bool loaded = false;
+  struct statx stat = {};
+  std::string buf;
+  std::size_t got = 0;
+};
+
+
+/// Queues a read of the rest of a file.
+static void queue_read(Ring &ring, std::size_t i, LoadState &state) {
+  io_uring_sqe *sqe = get_sqe(ring);
+  sqe->opcode = IORING_OP_READ;
+  sqe->fd = state.fd;
+  sqe->addr = reinterpret_cast<std::uint64_t>(state.buf.data() + state.got);
+  sqe->len = state.buf.size() - state.got;
+  sqe->off = state.got;
+  sqe->user_data = (i << 2) | OpRead;
+}
+
+
+/// Queues a close of a file.
+static void queue_close(Ring &ring, std::size_t i, LoadState &state) {
+  io_uring_sqe *sqe = get_sqe(ring);
+  sqe->opcode = IORING_OP_CLOSE;
+  sqe->fd = state.fd;
+  sqe->user_data = (i << 2) | OpClose;
+  state.fd = -1;
+}
+
+
+/// Loads files through io_uring. Files it failed on are left without contents.
+/// @returns `false` if io_uring is unavailable.
+static bool load_uring(std::vector<struct CFile> &files, const std::vector<std::size_t> &todo) {
+  Ring ring;
+  if (std::getenv("STATIMC_NO_URING") || !open_ring(ring)) {
+    return false;
+  }
+
+  std::vector<LoadState> states(files.size());
+  std::size_t next = 0;
+  unsigned int in_flight = 0;
+  std::size_t done = 0;
+
+  while (done < todo.size()) {
+    // start opening and sizing files while there is room, two operations each
+    while (next < todo.size() && in_flight + 2 <= ring.entries) {
+      const std::size_t i = todo[next++];
+      LoadState &state = states[i];
+      state.pending = 2;
+
+      io_uring_sqe *open_sqe = get_sqe(ring);
+      open_sqe->opcode = IORING_OP_OPENAT;
+      open_sqe->fd = AT_FDCWD;
+      open_sqe->addr = reinterpret_cast<std::uint64_t>(files[i].path.c_str());
+      open_sqe->open_flags = O_RDONLY | O_CLOEXEC;
+      open_sqe->user_data = (i << 2) | OpOpen;
+
+      io_uring_sqe *stat_sqe = get_sqe(ring);
+      stat_sqe->opcode = IORING_OP_STATX;
+      stat_sqe->fd = AT_FDCWD;
+      stat_sqe->addr = reinterpret_cast<std::uint64_t>(files[i].path.c_str());
+      stat_sqe->len = STATX_SIZE;
+      stat_sqe->off = reinterpret_cast<std::uint64_t>(&state.stat);
+      stat_sqe->user_data = (i << 2) | OpStat;
+      in_flight += 2;
+    }
+
+    const int entered = syscall(__NR_io_uring_enter, ring.fd, ring.unsubmitted, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+    if (entered < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+      break;
+    }
+    ring.unsubmitted -= std::max(entered, 0);
+
+    // each completion queues the next step of its file
+    unsigned int head = *ring.cq_head;
+    const unsigned int tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; head++) {
+      const io_uring_cqe *cqe = &ring.cqes[head & *ring.cq_mask];
+      const std::size_t i = cqe->user_data >> 2;
+      const int res = cqe->res;
+      LoadState &state = states[i];
+      in_flight--;
+
+      switch (cqe->user_data & 3) {
+        case OpOpen:
+        case OpStat:
+          if (res < 0) {
+            state.failed = true;
+          } else if ((cqe->user_data & 3) == OpOpen) {
+            state.fd = res;
+          }
+
+          if (--state.pending > 0) {
+            break;
+          } else if (state.failed || state.stat.stx_size == 0) {
+            if (state.fd >= 0) {
+              queue_close(ring, i, state);
+              in_flight++;
+            } else {
+              done++;
+            }
+            break;
+          }
+          state.buf.resize(state.stat.stx_size);
+          queue_read(ring, i, state);
+          in_flight++;
+          break;
+        case OpRead:
+          // a short read continues from where it stopped, and the end of the file stops early
+          if (res < 0) {
+            state.failed = true;
+          } else {
+            state.got += res;
+          }
+
+          if (!state.failed && res > 0 && state.got < state.buf.size()) {
+            queue_read(ring, i, state);
+          } else {
+            state.buf.resize(state.got);
+            queue_close(ring, i, state);
+          }
+          in_flight++;
+          break;
+        case OpClose:
+          state.loaded = !state.failed;
+          done++;
+          break;
+      }
+    }
+    __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+  }
+  close_ring(ring);
+
+  for (std::size_t i : todo) {
+    if (states[i].loaded) {
+      files[i].src = std::move(states[i].buf);
+    }
+  }
+  return done == todo.size();
+}
+
+
+/// Reads a file with `pread`.
+/// @returns `false` if the file could not be read.
+static bool read_file(const std::string &path, std::string &result) {
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return false;
+  }
+
+  result.resize(st.st_size);
+  std::size_t got = 0;
+  while (got < result.size()) {
+    const ssize_t n = pread(fd, result.data() + got, result.size() - got, got);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    } else if (n <= 0) {
+      break;
+    }
+    got += n;
+  }
+  result.resize(got);
+  close(fd);
+  return true;
+}
+
+
+/// Loads files with `pread` on a pool of threads.
+static void load_pread(std::vector<struct CFile> &files, const std::vector<std::size_t> &todo) {
+  std::atomic<std::size_t> next = 0;
+  const auto load_files = [&]() {
+    for (std::size_t i = next++; i < todo.size(); i = next++) {
+      std::string src;
+      if (read_file(files[todo[i]].path, src)) {
+        files[todo[i]].src = std::move(src);
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  const unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+  for (unsigned int i = 1; i < std::min<std::size_t>(threads, todo.size()); i++) {
+    workers.emplace_back(load_files);
+  }
+  load_files();
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+}
+
+
+void load_sources(std::vector<struct CFile> &files) {
+  std::vector<std::size_t> todo;
+  for (std::size_t i = 0; i < files.size(); i++) {
+    if (!files[i].src) {
+      todo.push_back(i);
+    }
+  }
+  if (todo.empty()) {
+    return;
+  }
+
+  // files io_uring could not load, for example because an operation is unsupported, get another try
+  load_uring(files, todo);
+  todo.erase(std::remove_if(todo.begin(), todo.end(), [&](std::size_t i) { return files[i].src.has_value(); }), todo.end());
+  load_pread(files, todo);
+}
@@ -0,0 +1,1044 @@
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdlib>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <poll.h>
+#include <sstream>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+#include "../include/ast/Builder.h"
+#include "../include/ast/Unit.h"
+#include "../include/core/Logger.h"
+#include "../include/core/Lsp.h"
+#include "../include/core/Utils.h"
+
+/// Json - A JSON value, as sent by the editor.
+struct Json {
+  enum Kind { Null, Bool, Number, String, Array, Object } kind = Null;
+  bool b = false;
+  double num = 0;
+  std::string str;
+  std::vector<Json> arr;
+  std::vector<std::pair<std::string, Json>> obj;
+
+  /// Returns a member of this object, or null if there is none.
+  const Json &operator[](const std::string &key) const {
+    static const Json null;
+    for (const std::pair<std::string, Json> &member : obj) {
+      if (member.first == key) {
+        return member.second;
+      }
+    }
+    return null;
+  }
+
+  /// Returns this value written back as JSON, to echo request ids.
+  std::string to_string() const;
+};
+
+
+/// Returns a string quoted and escaped as a JSON string.
+static std::string quote(const std::string &s) {
+  std::string result = "\"";
+  for (const unsigned char c : s) {
+    switch (c) {
+      case '"': result += "\\\""; break;
+      case '\\': result += "\\\\"; break;
+      case '\n': result += "\\n"; break;
+      case '\r': result += "\\r"; break;
+      case '\t': result += "\\t"; break;
+      default:
+        if (c < 0x20) {
+          char buf[8];
+          snprintf(buf, sizeof(buf), "\\u%04x", c);
+          result += buf;
+        } else {
+          result += c;
+        }
+    }
+  }
+  return result + '"';
+}
+
+
+std::string Json::to_string() const {
+  switch (kind) {
+    case Null: return "null";
+    case Bool: return b ? "true" : "false";
+    case Number: {
+      std::ostringstream out;
+      out << num;
+      return out.str();
+    }
+    case String: return quote(str);
+    case Array: {
+      std::string result = "[";
+      for (const Json &v : arr) {
+        result += (result.size() > 1 ? "," : "") + v.to_string();
+      }
+      return result + "]";
+    }
+    case Object: {
+      std::string result = "{";
+      for (const std::pair<std::string, Json> &member : obj) {
+        result += (result.size() > 1 ? "," : "") + quote(member.first) + ":" + member.second.to_string();
+      }
+      return result + "}";
+    }
+  }
+  return "null";
+}
+
+
+/// Parses the 4 hex digits of a `\\u` escape at `pos`, advancing past them.
+/// @returns `false` if they are not hex digits.
+static bool parse_hex4(const std::string &s, std::size_t &pos, unsigned int &cp) {
+  if (pos + 4 > s.size()) {
+    return false;
+  }
+
+  cp = 0;
+  for (std::size_t end = pos + 4; pos < end; pos++) {
+    const char c = s[pos];
+    if (!std::isxdigit(static_cast<unsigned char>(c))) {
+      return false;
+    }
+    cp = cp * 16 + (std::isdigit(static_cast<unsigned char>(c)) ? c - '0' : std::tolower(c) - 'a' + 10);
+  }
+  return true;
+}
+
+
+/// The deepest nesting of arrays and objects accepted from the editor, which bounds the recursion of the parser.
+static constexpr unsigned int max_json_depth = 512;
+
+/// Parses a JSON value starting at `pos`, advancing past it.
+/// @param depth The number of arrays and objects the value is nested in.
+/// @returns `false` if the input is not valid JSON, or is nested too deeply.
+static bool parse_json(const std::string &s, std::size_t &pos, Json &v, unsigned int depth = 0) {
+  const auto skip_ws = [&]() {
+    while (pos < s.size() && std::isspace(static_cast<unsigned char>(s[pos]))) {
+      pos++;
+    }
+  };
+
+  skip_ws();
+  if (pos >= s.size() || depth > max_json_depth) {
+    return false;
+  }
+
+  if (s[pos] == '{') {
+    v.kind = Json::Object;
+    pos++;  // eat open brace
+    skip_ws();
+    while (pos < s.size() && s[pos] != '}') {
+      Json key;
+      if (!v.obj.empty()) {
+        if (s[pos] != ',') {
+          return false;
+        }
+        pos++;  // eat comma
+      }
+
+      if (!parse_json(s, pos, key, depth + 1) || key.kind != Json::String) {
+        return false;
+      }
+      skip_ws();
+      if (pos >= s.size() || s[pos] != ':') {
+        return false;
+      }
+      pos++;  // eat colon
+
+      Json value;
+      if (!parse_json(s, pos, value, depth + 1)) {
+        return false;
+      }
+      v.obj.push_back({ key.str, std::move(value) });
+      skip_ws();
+    }
+    if (pos >= s.size()) {
+      return false;
+    }
+    pos++;  // eat close brace
+  } else if (s[pos] == '[') {
+    v.kind = Json::Array;
+    pos++;  // eat open bracket
+    skip_ws();
+    while (pos < s.size() && s[pos] != ']') {
+      if (!v.arr.empty()) {
+        if (s[pos] != ',') {
+          return false;
+        }
+        pos++;  // eat comma
+      }
+
+      Json element;
+      if (!parse_json(s, pos, element, depth + 1)) {
+        return false;
+      }
+      v.arr.push_back(std::move(element));
+      skip_ws();
+    }
+    if (pos >= s.size()) {
+      return false;
+    }
+    pos++;  // eat close bracket
+  } else if (s[pos] == '"') {
+    v.kind = Json::String;
+    pos++;  // eat open quote
+    while (pos < s.size() && s[pos] != '"') {
+      if (s[pos] != '\\') {
+        v.str += s[pos++];
+        continue;
+      }
+
+      pos++;  // eat backslash
+      const char c = pos < s.size() ? s[pos++] : '\0';
+      switch (c) {
+        case 'n': v.str += '\n'; break;
+        case 'r': v.str += '\r'; break;
+        case 't': v.str += '\t'; break;
+        case 'b': v.str += '\b'; break;
+        case 'f': v.str += '\f'; break;
+        case '"':
+        case '\\':
+        case '/': v.str += c; break;
+        case 'u': {
+          // code points are written back as utf-8, and surrogate pairs are joined
+          unsigned int cp = 0;
+          if (!parse_hex4(s, pos, cp)) {
+            return false;
+          }
+
+          unsigned int low = 0;
+          std::size_t low_pos = pos + 2;
+          if (cp >= 0xd800 && cp < 0xdc00 && s.compare(pos, 2, "\\u") == 0 && parse_hex4(s, low_pos, low) && \
+              low >= 0xdc00 && low < 0xe000) {
+            cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+            pos = low_pos;
+          }
+
+          if (cp < 0x80) {
+            v.str += static_cast<char>(cp);
+          } else if (cp < 0x800) {
+            v.str += static_cast<char>(0xc0 | (cp >> 6));
+            v.str += static_cast<char>(0x80 | (cp & 0x3f));
+          } else if (cp < 0x10000) {
+            v.str += static_cast<char>(0xe0 | (cp >> 12));
+            v.str += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+            v.str += static_cast<char>(0x80 | (cp & 0x3f));
+          } else {
+            v.str += static_cast<char>(0xf0 | (cp >> 18));
+            v.str += static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+            v.str += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+            v.str += static_cast<char>(0x80 | (cp & 0x3f));
+          }
+          break;
+        }
+        default: return false;
+      }
+    }
+    if (pos >= s.size()) {
+      return false;
+    }
+    pos++;  // eat close quote
+  } else if (s.compare(pos, 4, "true") == 0 || s.compare(pos, 5, "false") == 0) {
+    v.kind = Json::Bool;
+    v.b = s[pos] == 't';
+    pos += v.b ? 4 : 5;
+  } else if (s.compare(pos, 4, "null") == 0) {
+    pos += 4;
+  } else if (s[pos] == '-' || std::isdigit(static_cast<unsigned char>(s[pos]))) {
+    // numbers are read by strtod, which must take all of their characters
+    v.kind = Json::Number;
+    const std::size_t start = pos;
+    while (pos < s.size() && (std::isdigit(static_cast<unsigned char>(s[pos])) || std::strchr("+-.eE", s[pos]))) {
+      pos++;
+    }
+
+    const std::string num = s.substr(start, pos - start);
+    char *num_end = nullptr;
+    v.num = std::strtod(num.c_str(), &num_end);
+    if (num_end != num.c_str() + num.size()) {
+      return false;
+    }
+  } else {
+    return false;
+  }
+  return true;
+}
+
+
+/// Parses a whole message as a JSON value.
+/// @returns `false` if the message is not valid JSON.
+static bool parse_message(const std::string &body, Json &msg) {
+  std::size_t pos = 0;
+  if (!parse_json(body, pos, msg)) {
+    return false;
+  }
+
+  while (pos < body.size() && std::isspace(static_cast<unsigned char>(body[pos]))) {
+    pos++;
+  }
+  return pos == body.size();
+}
+
+
+/// Parses a decimal unsigned integer which makes up a whole string.
+/// @returns `false` if the string is not a number, or does not fit in `max`.
+static bool parse_uint(const std::string &s, unsigned long max, unsigned long &result) {
+  if (s.empty() || s.size() > 19 || s.find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+
+  result = std::strtoul(s.c_str(), nullptr, 10);
+  return result <= max;
+}
+
+
+/// Symbol - A declaration found by an analysis.
+///
+/// Locals are declared in a function, fields and methods in a struct, and
+/// variants in an enum, which is their parent.
+struct Symbol {
+  std::string kind;
+  std::string name;
+  std::string type;
+  std::string file;
+  unsigned int line;
+  unsigned int col;
+  std::string parent;
+};
+
+
+/// Writes a declaration to the symbol table of an analysis.
+static void put_symbol(FILE *out, const std::string &kind, const std::string &name, const Type *T,
+                       const Metadata &meta, const std::string &parent) {
+  fprintf(out, "%s\t%s\t%s\t%s\t%u\t%u\t%s\n", kind.c_str(), name.c_str(), T ? T->to_string().c_str() : "void",
+    meta.filename.c_str(), meta.line_n, meta.col_n, parent.c_str());
+}
+
+
+/// Writes the locals declared in a statement to the symbol table of an analysis.
+static void put_locals(FILE *out, Stmt *s, const std::string &fn) {
+  if (!s) {
+    return;
+  } else if (CompoundStmt *compound = dynamic_cast<CompoundStmt *>(s)) {
+    for (Stmt *stmt : compound->get_stmts()) {
+      put_locals(out, stmt, fn);
+    }
+  } else if (DeclStmt *decl = dynamic_cast<DeclStmt *>(s)) {
+    if (VarDecl *var = dynamic_cast<VarDecl *>(decl->get_decl())) {
+      put_symbol(out, "var", var->get_name(), var->get_type(), var->get_meta(), fn);
+    }
+  } else if (IfStmt *if_stmt = dynamic_cast<IfStmt *>(s)) {
+    put_locals(out, if_stmt->get_then_body(), fn);
+    put_locals(out, if_stmt->get_else_body(), fn);
+  } else if (UntilStmt *until = dynamic_cast<UntilStmt *>(s)) {
+    put_locals(out, until->get_body(), fn);
+  } else if (ForStmt *for_stmt = dynamic_cast<ForStmt *>(s)) {
+    if (VarDecl *var = dynamic_cast<VarDecl *>(for_stmt->get_var())) {
+      put_symbol(out, "var", var->get_name(), var->get_type(), var->get_meta(), fn);
+    }
+    put_locals(out, for_stmt->get_body(), fn);
+  } else if (MatchStmt *match = dynamic_cast<MatchStmt *>(s)) {
+    for (MatchCase *c : match->get_cases()) {
+      put_locals(out, c->get_body(), fn);
+    }
+  }
+}
+
+
+/// Writes a function and its parameters and locals to the symbol table of an analysis.
+static void put_function(FILE *out, FunctionDecl *fn, const std::string &kind, const std::string &parent) {
+  put_symbol(out, kind, fn->get_name(), fn->get_type(), fn->get_meta(), parent);
+  for (ParamVarDecl *param : fn->get_params()) {
+    put_symbol(out, "param", param->get_name(), param->get_type(), param->get_meta(), fn->get_name());
+  }
+  put_locals(out, fn->get_body(), fn->get_name());
+}
+
+
+/// Writes the symbol table of a crate, ended by a line holding only `.`.
+static void put_symbols(FILE *out, CrateUnit *crate) {
+  for (PackageUnit *pkg : crate->get_packages()) {
+    for (Decl *d : pkg->get_decls()) {
+      if (FunctionDecl *fn = dynamic_cast<FunctionDecl *>(d)) {
+        put_function(out, fn, "fn", "");
+      } else if (StructDecl *struct_d = dynamic_cast<StructDecl *>(d)) {
+        put_symbol(out, "struct", struct_d->get_name(), struct_d->get_type(), struct_d->get_meta(), "");
+        for (FieldDecl *field : struct_d->get_fields()) {
+          put_symbol(out, "field", field->get_name(), field->get_type(), field->get_meta(), struct_d->get_name());
+        }
+      } else if (ImplDecl *impl = dynamic_cast<ImplDecl *>(d)) {
+        for (FunctionDecl *method : impl->get_methods()) {
+          put_function(out, method, "method", impl->get_struct_name());
+        }
+      } else if (EnumDecl *enum_d = dynamic_cast<EnumDecl *>(d)) {
+        put_symbol(out, "enum", enum_d->get_name(), enum_d->get_type(), enum_d->get_meta(), "");
+        for (EnumVariantDecl *variant : enum_d->get_variants()) {
+          put_symbol(out, "variant", variant->get_name(), enum_d->get_type(), variant->get_meta(), enum_d->get_name());
+        }
+      } else if (TraitDecl *trait = dynamic_cast<TraitDecl *>(d)) {
+        put_symbol(out, "trait", trait->get_name(), nullptr, trait->get_meta(), "");
+      } else if (VarDecl *var = dynamic_cast<VarDecl *>(d)) {
+        put_symbol(out, "var", var->get_name(), var->get_type(), var->get_meta(), "");
+      }
+    }
+  }
+  fprintf(out, ".\n");
+  fflush(out);
+}
+
+
+/// Analyzes a crate in a forked child, writing its symbols to standard output and its panics and warnings to
+/// standard error.
+///
+/// Symbols are written once after parsing, so that a crate which fails to check
+/// still has them, and again with their resolved types after checking.
+[[noreturn]]
+static void analyze(std::vector<struct CFile> files) {
+  struct CFlags flags = {};
+  std::unique_ptr<ASTContext> ctx = std::make_unique<ASTContext>(flags, std::move(files));
+  std::unique_ptr<CrateUnit> crate = build_ast(ctx);
+  put_symbols(stdout, crate.get());
+
+  std::unique_ptr<PassVisitor> visitor = std::make_unique<PassVisitor>();
+  crate->pass(visitor.get());
+  put_symbols(stdout, crate.get());
+  _exit(0);
+}
+
+
+static std::mutex lock;
+static std::condition_variable dirty_cv;
+static bool dirty = false;
+static unsigned int generation = 0;
+static pid_t running = 0;
+static std::filesystem::path root;
+static std::vector<struct CFile> (*find_files)(const std::filesystem::path &) = nullptr;
+static std::map<std::string, std::string> docs = {};
+static std::vector<Symbol> symbols = {};
+static std::vector<std::string> published = {};
+static std::map<std::string, std::string> filenames = {};
+static std::string last_uri;
+
+/// Writes a message to the editor.
+static void send(const std::string &body) {
+  static std::mutex out_lock;
+  std::lock_guard<std::mutex> guard(out_lock);
+  fprintf(stdout, "Content-Length: %zu\r\n\r\n%s", body.size(), body.c_str());
+  fflush(stdout);
+}
+
+
+/// Returns the path of a `file://` URI.
+static std::string uri_to_path(const std::string &uri) {
+  std::string path;
+  for (std::size_t i = uri.rfind("file://", 0) == 0 ? 7 : 0; i < uri.size(); i++) {
+    if (uri[i] == '%' && i + 2 < uri.size() && std::isxdigit(static_cast<unsigned char>(uri[i + 1])) && \
+        std::isxdigit(static_cast<unsigned char>(uri[i + 2]))) {
+      path += static_cast<char>(std::strtoul(uri.substr(i + 1, 2).c_str(), nullptr, 16));
+      i += 2;
+    } else {
+      path += uri[i];
+    }
+  }
+  return path;
+}
+
+
+/// Returns the `file://` URI of a path.
+static std::string path_to_uri(const std::string &path) {
+  std::string uri = "file://";
+  for (const unsigned char c : path) {
+    if (std::isalnum(c) || std::strchr("/-_.~", c)) {
+      uri += c;
+    } else {
+      char buf[4];
+      snprintf(buf, sizeof(buf), "%%%02X", c);
+      uri += buf;
+    }
+  }
+  return uri;
+}
+
+
+/// Returns the contents of a document, from the editor if it is open or from disk otherwise.
+static std::string get_text(const std::string &uri) {
+  if (docs.find(uri) != docs.end()) {
+    return docs.at(uri);
+  }
+  return read_to_str(uri_to_path(uri));
+}
+
+
+/// Returns a line of a document.
+static std::string get_line(const std::string &text, unsigned int line) {
+  std::size_t pos = 0;
+  for (unsigned int i = 0; i < line && pos != std::string::npos; i++) {
+    pos = text.find('\n', pos);
+    pos = pos == std::string::npos ? pos : pos + 1;
+  }
+  if (pos == std::string::npos) {
+    return "";
+  }
+  return text.substr(pos, text.find('\n', pos) - pos);
+}
+
+
+static bool is_ident_char(char c) {
+  return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+
+/// Returns the identifier ending at a column of a line, with the receiver it is accessed on if it follows a `.`.
+static std::pair<std::string, std::string> get_word(const std::string &line, std::size_t col, bool whole) {
+  col = std::min(col, line.size());
+  std::size_t start = col;
+  while (start > 0 && is_ident_char(line[start - 1])) {
+    start--;
+  }
+
+  std::size_t end = col;
+  while (whole && end < line.size() && is_ident_char(line[end])) {
+    end++;
+  }
+
+  std::string receiver;
+  if (start > 0 && line[start - 1] == '.') {
+    std::size_t recv = start - 1;
+    while (recv > 0 && is_ident_char(line[recv - 1])) {
+      recv--;
+    }
+    receiver = line.substr(recv, start - 1 - recv);
+  }
+  return { line.substr(start, end - start), receiver };
+}
+
+
+/// Returns the file name a URI is reported under by the compiler, which is its path from a root for packages found
+/// through a manifest. Callers hold the lock.
+static std::string get_filename(const std::string &uri) {
+  const std::filesystem::path path = uri_to_path(uri);
+  const auto it = filenames.find(path.string());
+  return it != filenames.end() ? it->second : path.filename().string();
+}
+
+
+/// Returns the struct a receiver refers to at a line of a file.
+static std::string get_receiver_struct(const std::string &receiver, const std::string &file, unsigned int line);
+
+/// Finds the declaration a name refers to at a line of a file.
+///
+/// Locals resolve to the closest declaration above the line. Other names resolve
+/// to the declarations of the crate, and members to those of the struct they are
+/// accessed on.
+static const Symbol *find_symbol(const std::string &name, const std::string &receiver, const std::string &file, unsigned int line) {
+  if (!receiver.empty()) {
+    const std::string struct_name = get_receiver_struct(receiver, file, line);
+    for (const Symbol &s : symbols) {
+      if ((s.kind == "field" || s.kind == "method") && s.parent == struct_name && s.name == name) {
+        return &s;
+      }
+    }
+    return nullptr;
+  }
+
+  const Symbol *local = nullptr;
+  for (const Symbol &s : symbols) {
+    if ((s.kind == "var" || s.kind == "param") && s.name == name && s.file == file && s.line <= line && \
+        (!local || s.line >= local->line)) {
+      local = &s;
+    }
+  }
+  if (local) {
+    return local;
+  }
+
+  for (const Symbol &s : symbols) {
+    if (s.name == name && s.kind != "var" && s.kind != "param" && s.kind != "field" && s.kind != "method") {
+      return &s;
+    }
+  }
+
+  for (const Symbol &s : symbols) {
+    if (s.name == name) {
+      return &s;
+    }
+  }
+  return nullptr;
+}
+
+
+static std::string get_receiver_struct(const std::string &receiver, const std::string &file, unsigned int line) {
+  if (receiver != "this") {
+    const Symbol *recv = find_symbol(receiver, "", file, line);
+    return recv ? recv->type : "";
+  }
+
+  // the receiver of `this` is the struct of the closest method above
+  const Symbol *method = nullptr;
+  for (const Symbol &s : symbols) {
+    if (s.kind == "method" && s.file == file && s.line <= line && (!method || s.line > method->line)) {
+      method = &s;
+    }
+  }
+  return method ? method->parent : "";
+}
+
+
+/// Finds the source files of the crate. Panics, like those of a half-edited manifest, are collected rather than
+/// exiting the server.
+/// @param err Set to the panics, written as the compiler prints them, if the crate could not be found.
+/// @returns   `false` if the crate could not be found.
+static bool find_crate(std::vector<struct CFile> &files, std::string &err) {
+  std::vector<Diagnostic> diags;
+  diag_sink = &diags;
+  bool found = true;
+  try {
+    files = find_files(root);
+  } catch (const CompileError &) {
+    found = false;
+  } catch (const std::exception &e) {
+    diags.push_back({ true, e.what(), Metadata(), false });
+    found = false;
+  }
+  diag_sink = nullptr;
+
+  for (const Diagnostic &diag : diags) {
+    err += std::string("statimc: ") + (diag.is_panic ? "panic: " : "warn: ") + diag.msg + '\n';
+    if (diag.has_meta) {
+      err += "see: " + diag.meta.filename + ':' + std::to_string(diag.meta.line_n) + ':' + \
+        std::to_string(diag.meta.col_n) + '\n';
+    }
+  }
+  return found;
+}
+
+
+/// Returns the URI of the file a symbol is declared in.
+static std::string get_symbol_uri(const Symbol &s) {
+  std::vector<struct CFile> files;
+  std::string err;
+  find_crate(files, err);
+  for (const struct CFile &file : files) {
+    if (file.filename == s.file) {
+      return path_to_uri(file.path);
+    }
+  }
+  for (const auto &[uri, text] : docs) {
+    if (get_filename(uri) == s.file) {
+      return uri;
+    }
+  }
+  return path_to_uri((root / s.file).string());
+}
+
+
+/// Returns an LSP range over the identifier starting at a 1-based line and column of a document.
+static std::string get_range(const std::string &uri, unsigned int line, unsigned int col) {
+  const unsigned int l = line > 0 ? line - 1 : 0;
+  const unsigned int c = col > 0 ? col - 1 : 0;
+  const std::string text = get_line(get_text(uri), l);
+  unsigned int end = c;
+  while (end < text.size() && is_ident_char(text[end])) {
+    end++;
+  }
+  end = end == c ? c + 1 : end;
+  return "{\"start\":{\"line\":" + std::to_string(l) + ",\"character\":" + std::to_string(c) + \
+    "},\"end\":{\"line\":" + std::to_string(l) + ",\"character\":" + std::to_string(end) + "}}";
+}
+
+
+/// Publishes the panics and warnings an analysis wrote, and clears those of files which no longer have any.
+static void publish_diagnostics(const std::string &err, const std::vector<struct CFile> &files) {
+  std::map<std::string, std::vector<std::string>> diags;
+  std::istringstream lines(err);
+  std::string line;
+  std::string msg;
+  int severity = 0;
+  const auto flush = [&](const std::string &file, unsigned int l, unsigned int c) {
+    if (severity == 0) {
+      return;
+    }
+
+    std::string uri = last_uri;
+    for (const struct CFile &f : files) {
+      if (!file.empty() && f.filename == file) {
+        uri = path_to_uri(f.path);
+      }
+    }
+    diags[uri].push_back("{\"range\":" + get_range(uri, l, c) + ",\"severity\":" + std::to_string(severity) + \
+      ",\"source\":\"statimc\",\"message\":" + quote(msg) + "}");
+    severity = 0;
+  };
+
+  while (std::getline(lines, line)) {
+    if (line.rfind("see: ", 0) == 0 && severity != 0) {
+      // locations are `<file>:<line>:<col>`
+      const std::size_t col_sep = line.rfind(':');
+      const std::size_t line_sep = line.rfind(':', col_sep - 1);
+      unsigned long l = 0, c = 0;
+      if (col_sep != std::string::npos && line_sep != std::string::npos && line_sep > 5 && \
+          parse_uint(line.substr(line_sep + 1, col_sep - line_sep - 1), UINT_MAX, l) && \
+          parse_uint(line.substr(col_sep + 1), UINT_MAX, c)) {
+        flush(line.substr(5, line_sep - 5), l, c);
+      }
+      continue;
+    }
+
+    flush("", 0, 0);
+    if (line.rfind("statimc: panic: ", 0) == 0) {
+      severity = 1;
+      msg = line.substr(16);
+    } else if (line.rfind("statimc: warn: ", 0) == 0) {
+      severity = 2;
+      msg = line.substr(15);
+    }
+  }
+  flush("", 0, 0);
+
+  std::vector<std::string> uris = published;
+  for (const auto &[uri, list] : diags) {
+    if (std::find(uris.begin(), uris.end(), uri) == uris.end()) {
+      uris.push_back(uri);
+    }
+  }
+
+  published.clear();
+  for (const std::string &uri : uris) {
+    std::string body = "[";
+    if (diags.find(uri) != diags.end()) {
+      for (const std::string &diag : diags.at(uri)) {
+        body += (body.size() > 1 ? "," : "") + diag;
+      }
+      published.push_back(uri);
+    }
+    send("{\"jsonrpc\":\"2.0\",\"method\":\"textDocument/publishDiagnostics\",\"params\":{\"uri\":" + quote(uri) + \
+      ",\"diagnostics\":" + body + "]}}");
+  }
+}
+
+
+/// Parses the symbol tables an analysis wrote, keeping the last complete one.
+static bool parse_symbols(const std::string &out, std::vector<Symbol> &result) {
+  std::istringstream lines(out);
+  std::string line;
+  std::vector<Symbol> table;
+  bool complete = false;
+  while (std::getline(lines, line)) {
+    if (line == ".") {
+      result = std::move(table);
+      table.clear();
+      complete = true;
+      continue;
+    }
+
+    std::vector<std::string> fields;
+    std::size_t pos = 0;
+    while (pos <= line.size()) {
+      const std::size_t tab = std::min(line.find('\t', pos), line.size());
+      fields.push_back(line.substr(pos, tab - pos));
+      pos = tab + 1;
+    }
+    unsigned long l = 0, c = 0;
+    if (fields.size() == 7 && parse_uint(fields[4], UINT_MAX, l) && parse_uint(fields[5], UINT_MAX, c)) {
+      table.push_back({ fields[0], fields[1], fields[2], fields[3], \
+        static_cast<unsigned int>(l), static_cast<unsigned int>(c), fields[6] });
+    }
+  }
+  return complete;
+}
+
+
+/// Analyzes the crate in the background whenever a document changes.
+static void analysis_loop(void) {
+  while (true) {
+    std::vector<struct CFile> files;
+    unsigned int gen = 0;
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      dirty_cv.wait(guard, [] { return dirty; });
+      dirty = false;
+      gen = generation;
+
+      // a crate which cannot be found reports why on its manifest
+      std::string err;
+      if (!find_crate(files, err)) {
+        const std::filesystem::path manifest = root / "statim.toml";
+        publish_diagnostics(err, { { manifest.filename().string(), manifest.string(), std::nullopt } });
+        continue;
+      }
+
+      // open documents take the place of their files, and are added if they are not saved yet
+      for (const auto &[uri, text] : docs) {
+        const std::filesystem::path path = uri_to_path(uri);
+        bool found = false;
+        for (struct CFile &file : files) {
+          if (file.path == path.string()) {
+            file.src = text;
+            found = true;
+          }
+        }
+        if (!found && path.extension() == ".statim") {
+          files.push_back({ path.filename().string(), path.string(), text });
+        }
+      }
+
+      filenames.clear();
+      for (const struct CFile &file : files) {
+        filenames[file.path] = file.filename;
+      }
+    }
+
+    int out[2], err[2];
+    if (files.empty() || pipe(out) != 0 || pipe(err) != 0) {
+      continue;
+    }
+
+    const pid_t pid = fork();
+    if (pid == 0) {
+      dup2(out[1], STDOUT_FILENO);
+      dup2(err[1], STDERR_FILENO);
+      close(out[0]);
+      close(err[0]);
+      analyze(std::move(files));
+    }
+    close(out[1]);
+    close(err[1]);
+
+    {
+      // a newer edit may have arrived while forking
+      std::lock_guard<std::mutex> guard(lock);
+      running = pid;
+      if (gen != generation && pid > 0) {
+        kill(pid, SIGKILL);
+      }
+    }
+
+    std::string result[2];
+    pollfd pfds[2] = { { out[0], POLLIN, 0 }, { err[0], POLLIN, 0 } };
+    int open_fds = 2;
+    while (pid > 0 && open_fds > 0 && poll(pfds, 2, -1) > 0) {
+      for (int i = 0; i < 2; i++) {
+        if (pfds[i].fd < 0 || !pfds[i].revents) {
+          continue;
+        }
+
+        char buf[1 << 14];
+        const ssize_t n = read(pfds[i].fd, buf, sizeof(buf));
+        if (n <= 0) {
+          pfds[i].fd = -1;
+          open_fds--;
+        } else {
+          result[i].append(buf, n);
+        }
+      }
+    }
+    close(out[0]);
+    close(err[0]);
+    if (pid > 0) {
+      waitpid(pid, nullptr, 0);
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    running = 0;
+    if (gen != generation) {
+      continue;  // cancelled by a newer edit
+    }
+
+    std::vector<Symbol> table;
+    if (parse_symbols(result[0], table)) {
+      symbols = std::move(table);
+    }
+    publish_diagnostics(result[1], files);
+  }
+}
+
+
+/// Queues an analysis of the crate, cancelling the one running.
+static void schedule(const std::string &uri) {
+  std::lock_guard<std::mutex> guard(lock);
+  last_uri = uri;
+  dirty = true;
+  generation++;
+  if (running > 0) {
+    kill(running, SIGKILL);
+  }
+  dirty_cv.notify_one();
+}
+
+
+/// Returns the LSP kind of a completion item for a symbol.
+static int get_completion_kind(const Symbol &s) {
+  if (s.kind == "method") {
+    return 2;
+  } else if (s.kind == "fn") {
+    return 3;
+  } else if (s.kind == "field") {
+    return 5;
+  } else if (s.kind == "struct") {
+    return 22;
+  } else if (s.kind == "enum") {
+    return 13;
+  } else if (s.kind == "variant") {
+    return 20;
+  } else if (s.kind == "trait") {
+    return 8;
+  }
+  return 6;
+}
+
+
+/// Answers a hover, definition or completion request from the symbols of the last analysis.
+static std::string answer(const std::string &method, const Json &params) {
+  const std::string uri = params["textDocument"]["uri"].str;
+  const unsigned int line = params["position"]["line"].num;
+  const unsigned int col = params["position"]["character"].num;
+  const std::string text = get_line(get_text(uri), line);
+
+  std::lock_guard<std::mutex> guard(lock);
+  const std::string file = get_filename(uri);
+  if (method == "textDocument/completion") {
+    const auto [prefix, receiver] = get_word(text, col, false);
+    const std::string struct_name = receiver.empty() ? "" : get_receiver_struct(receiver, file, line + 1);
+
+    std::string items = "[";
+    for (const Symbol &s : symbols) {
+      const bool member = (s.kind == "field" || s.kind == "method") && s.parent == struct_name;
+      const bool local = (s.kind == "var" || s.kind == "param") && s.file == file && s.line <= line + 1;
+      const bool global = s.kind != "var" && s.kind != "param" && s.kind != "field" && s.kind != "method";
+      if (receiver.empty() ? !(local || global) : !member) {
+        continue;
+      }
+      items += (items.size() > 1 ? "," : "") + std::string("{\"label\":") + quote(s.name) + \
+        ",\"kind\":" + std::to_string(get_completion_kind(s)) + ",\"detail\":" + quote(s.type) + "}";
+    }
+    return items + "]";
+  }
+
+  const auto [name, receiver] = get_word(text, col, true);
+  const Symbol *s = name.empty() ? nullptr : find_symbol(name, receiver, file, line + 1);
+  if (!s) {
+    return "null";
+  }
+
+  if (method == "textDocument/definition") {
+    const std::string def_uri = get_symbol_uri(*s);
+    return "{\"uri\":" + quote(def_uri) + ",\"range\":" + get_range(def_uri, s->line, s->col) + "}";
+  }
+
+  const std::string owner = s->kind == "field" || s->kind == "method" ? s->parent + "." : "";
+  const std::string type = s->kind == "struct" || s->kind == "enum" || s->kind == "trait" ? "" : ": " + s->type;
+  return "{\"contents\":{\"kind\":\"markdown\",\"value\":" + \
+    quote("```\n" + s->kind + " " + owner + s->name + type + "\n```") + "}}";
+}
+
+
+/// The largest message accepted from the editor, in bytes.
+static constexpr unsigned long max_message = 1ul << 28;
+
+/// Reads a message from the editor. A message with a malformed length is read as empty, so it is answered as a
+/// parse error.
+/// @returns `false` once the editor closes the stream.
+static bool recv(std::string &body) {
+  unsigned long len = 0;
+  char header[256];
+  while (fgets(header, sizeof(header), stdin)) {
+    if (std::strcmp(header, "\r\n") == 0 || std::strcmp(header, "\n") == 0) {
+      body.assign(len, '\0');
+      return fread(body.data(), 1, len, stdin) == len;
+    } else if (strncasecmp(header, "Content-Length:", 15) == 0) {
+      std::string value = header + 15;
+      value.erase(std::remove_if(value.begin(), value.end(), [](char c) {
+        return std::isspace(static_cast<unsigned char>(c));
+      }), value.end());
+      if (!parse_uint(value, max_message, len)) {
+        len = 0;
+      }
+    }
+  }
+  return false;
+}
+
+
+void run_lsp(std::vector<struct CFile> (*find)(const std::filesystem::path &)) {
+  find_files = find;
+  root = std::filesystem::current_path();
+  signal(SIGPIPE, SIG_IGN);
+  std::thread(analysis_loop).detach();
+
+  std::string body;
+  while (recv(body)) {
+    Json msg;
+    if (!parse_message(body, msg)) {
+      send("{\"jsonrpc\":\"2.0\",\"id\":null,\"error\":{\"code\":-32700,\"message\":\"parse error\"}}");
+      continue;
+    }
+
+    const std::string method = msg["method"].str;
+    const Json &params = msg["params"];
+    const std::string id = msg["id"].to_string();
+    const bool is_request = msg["id"].kind != Json::Null;
+
+    if (method == "initialize") {
+      if (params["rootUri"].kind == Json::String) {
+        root = uri_to_path(params["rootUri"].str);
+      }
+      send("{\"jsonrpc\":\"2.0\",\"id\":" + id + ",\"result\":{\"capabilities\":{\"textDocumentSync\":1," \
+        "\"hoverProvider\":true,\"definitionProvider\":true,\"completionProvider\":{\"triggerCharacters\":[\".\"]}}," \
+        "\"serverInfo\":{\"name\":\"statimc\"}}}");
+    } else if (method == "shutdown") {
+      send("{\"jsonrpc\":\"2.0\",\"id\":" + id + ",\"result\":null}");
+    } else if (method == "exit") {
+      break;
+    } else if (method == "textDocument/didOpen") {
+      const std::string uri = params["textDocument"]["uri"].str;
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        docs[uri] = params["textDocument"]["text"].str;
+      }
+      schedule(uri);
+    } else if (method == "textDocument/didChange") {
+      // documents are synced in full, so the last change holds the whole text
+      const std::string uri = params["textDocument"]["uri"].str;
+      const std::vector<Json> &changes = params["contentChanges"].arr;
+      if (!changes.empty()) {
+        std::lock_guard<std::mutex> guard(lock);
+        docs[uri] = changes.back()["text"].str;
+      }
+      schedule(uri);
+    } else if (method == "textDocument/didClose") {
+      const std::string uri = params["textDocument"]["uri"].str;
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        docs.erase(uri);
+      }
+      schedule(uri);
+    } else if (method == "textDocument/didSave") {
+      schedule(params["textDocument"]["uri"].str);
+    } else if (method == "textDocument/hover" || method == "textDocument/definition" || method == "textDocument/completion") {
+      send("{\"jsonrpc\":\"2.0\",\"id\":" + id + ",\"result\":" + answer(method, params) + "}");
+    } else if (is_request) {
+      send("{\"jsonrpc\":\"2.0\",\"id\":" + id + ",\"error\":{\"code\":-32601,\"message\":" + \
+        quote("unsupported method: " + method) + "}}");
+    }
+    // other notifications, like cancellations of requests which are always answered at once, need no reply
+  }
+
+  std::lock_guard<std::mutex> guard(lock);
+  if (running > 0) {
+    kill(running, SIGKILL);
+  }
+  _exit(0);
+}
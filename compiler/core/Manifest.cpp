@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include "../include/core/Loader.h"
+#include "../include/core/Logger.h"
+#include "../include/core/Manifest.h"
+#include "../include/core/Utils.h"
+
+/// The name of the manifest file of a crate.
+static const std::string manifest_name = "statim.toml";
+
+/// Parses a quoted string of a manifest at `pos`, advancing past it.
+static std::string parse_string(const std::string &line, std::size_t &pos, const Metadata &meta) {
+  if (pos >= line.size() || line[pos] != '"') {
+    panic("expected string in manifest", meta);
+  }
+
+  const std::size_t end = line.find('"', pos + 1);
+  if (end == std::string::npos) {
+    panic("unterminated string in manifest", meta);
+  }
+
+  const std::string value = line.substr(pos + 1, end - pos - 1);
+  pos = end + 1;
+  return value;
+}
+
+
+bool load_manifest(const std::filesystem::path &dir, Manifest &manifest) {
+  const std::filesystem::path path = dir / manifest_name;
+  if (!std::filesystem::is_regular_file(path)) {
+    return false;
+  }
+
+  manifest.entry = "main";
+  manifest.roots.clear();
+
+  std::istringstream lines(read_to_str(path.string()));
+  std::string line;
+  for (unsigned int line_n = 1; std::getline(lines, line); line_n++) {
+    // whitespace is only kept inside strings
+    bool in_str = false;
+    line.erase(std::remove_if(line.begin(), line.end(), [&](char c) {
+      in_str ^= c == '"';
+      return !in_str && std::isspace(static_cast<unsigned char>(c));
+    }), line.end());
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+
+    const Metadata meta(manifest_name, line_n, 1);
+    const std::size_t eq = line.find('=');
+    if (eq == std::string::npos) {
+      panic("expected '=' in manifest", meta);
+    }
+
+    const std::string key = line.substr(0, eq);
+    std::size_t pos = eq + 1;
+    if (key == "entry") {
+      manifest.entry = parse_string(line, pos, meta);
+    } else if (key == "roots") {
+      if (pos >= line.size() || line[pos] != '[') {
+        panic("expected list of roots in manifest", meta);
+      }
+      pos++;  // eat open bracket
+
+      while (pos < line.size() && line[pos] != ']') {
+        manifest.roots.push_back(dir / parse_string(line, pos, meta));
+        if (pos < line.size() && line[pos] == ',') {
+          pos++;  // eat comma
+        }
+      }
+      if (pos >= line.size()) {
+        panic("expected ']' in manifest", meta);
+      }
+      pos++;  // eat close bracket
+    } else {
+      panic("unknown manifest key: " + key, meta);
+    }
+
+    if (pos < line.size() && line[pos] != '#') {
+      panic("unexpected input after manifest value", meta);
+    }
+  }
+
+  if (manifest.roots.empty()) {
+    manifest.roots.push_back(dir);
+  }
+  return true;
+}
+
+
+/// Returns the path of the file of a package in the first root holding it, or an empty path if none do.
+static std::filesystem::path find_package(const Manifest &manifest, const std::string &pkg) {
+  for (const std::filesystem::path &root : manifest.roots) {
+    const std::filesystem::path path = root / (pkg + ".statim");
+    if (std::filesystem::is_regular_file(path)) {
+      return path;
+    }
+  }
+  return {};
+}
+
+
+std::vector<struct CFile> discover_files(const Manifest &manifest) {
+  if (find_package(manifest, manifest.entry).empty()) {
+    panic("entry package not found in search roots: " + manifest.entry);
+  }
+
+  std::vector<struct CFile> files;
+  std::set<std::string> seen = { manifest.entry };
+  std::vector<std::string> level = { manifest.entry };
+  const unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+
+  while (!level.empty()) {
+    // the packages of a level are found on threads, then read in one batch
+    std::vector<struct CFile> found(level.size());
+    std::atomic<std::size_t> next = 0;
+    const auto find_level = [&]() {
+      for (std::size_t i = next++; i < level.size(); i = next++) {
+        // packages are named by their import path, so `a::b` is package `a/b` and not `b`
+        const std::filesystem::path path = find_package(manifest, level[i]);
+        found[i].filename = level[i] + ".statim";
+        found[i].path = path.string();
+      }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < std::min<std::size_t>(threads, level.size()); i++) {
+      workers.emplace_back(find_level);
+    }
+    find_level();
+    for (std::thread &worker : workers) {
+      worker.join();
+    }
+
+    found.erase(std::remove_if(found.begin(), found.end(), [](const struct CFile &file) {
+      return file.path.empty();
+    }), found.end());
+    load_sources(found);
+
+    std::vector<std::string> next_level;
+    for (struct CFile &file : found) {
+      for (const std::string &import : scan_imports(file.src ? *file.src : "")) {
+        if (seen.insert(import).second) {
+          next_level.push_back(import);
+        }
+      }
+      files.push_back(std::move(file));
+    }
+    level = std::move(next_level);
+  }
+
+  // packages are parsed from the last file to the first
+  std::reverse(files.begin(), files.end());
+  return files;
+}
@@ -0,0 +1,256 @@
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../include/core/Logger.h"
+#include "../include/core/Server.h"
+
+/// Writes all of a buffer to a file descriptor.
+static bool write_full(int fd, const void *buf, std::size_t len) {
+  const char *p = static_cast<const char *>(buf);
+  while (len > 0) {
+    const ssize_t n = write(fd, p, len);
+    if (n <= 0) {
+      return false;
+    }
+    p += n;
+    len -= n;
+  }
+  return true;
+}
+
+
+/// Reads exactly `len` bytes from a file descriptor.
+static bool read_full(int fd, void *buf, std::size_t len) {
+  char *p = static_cast<char *>(buf);
+  while (len > 0) {
+    const ssize_t n = read(fd, p, len);
+    if (n <= 0) {
+      return false;
+    }
+    p += n;
+    len -= n;
+  }
+  return true;
+}
+
+
+/// Returns the address of a socket path.
+static sockaddr_un get_addr(const std::string &path) {
+  sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) {
+    panic("server socket path is too long: " + path);
+  }
+  std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+  return addr;
+}
+
+
+/// The largest request payload accepted, in bytes.
+static constexpr std::uint32_t max_request = 1 << 20;
+
+/// Closes every descriptor passed in the control messages of a received message.
+static void close_rights(msghdr &msg) {
+  for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+      continue;
+    }
+
+    const std::size_t n = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    for (std::size_t i = 0; i < n; i++) {
+      int fd;
+      std::memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(fd));
+      close(fd);
+    }
+  }
+}
+
+
+/// Receives a request and the output descriptors of its client from a connection.
+///
+/// Requests are a 32-bit length carrying the descriptors, followed by the
+/// working directory and each argument, all null terminated. Descriptors of
+/// rejected requests are closed.
+static bool recv_request(int conn, ServerRequest &req) {
+  std::uint32_t len = 0;
+  iovec iov = { &len, sizeof(len) };
+  alignas(cmsghdr) char control[CMSG_SPACE(2 * sizeof(int))] = {};
+  msghdr msg = {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  const ssize_t got = recvmsg(conn, &msg, MSG_WAITALL | MSG_CMSG_CLOEXEC);
+  if (got < 0) {
+    return false;
+  }
+
+  cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+  if (got != sizeof(len) || len > max_request || (msg.msg_flags & MSG_CTRUNC) || !cmsg || \
+      cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS || cmsg->cmsg_len != CMSG_LEN(2 * sizeof(int))) {
+    close_rights(msg);
+    return false;
+  }
+  int fds[2];
+  std::memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+  req.out = fds[0];
+  req.err = fds[1];
+
+  std::string payload(len, '\0');
+  if (!read_full(conn, payload.data(), len)) {
+    close(req.out);
+    close(req.err);
+    return false;
+  }
+
+  std::size_t pos = 0;
+  while (pos < payload.size()) {
+    const std::size_t end = payload.find('\0', pos);
+    const std::string field = payload.substr(pos, end - pos);
+    if (pos == 0) {
+      req.cwd = field;
+    } else {
+      req.args.push_back(field);
+    }
+    pos = end == std::string::npos ? payload.size() : end + 1;
+  }
+
+  if (req.cwd.empty() || req.args.empty()) {
+    close(req.out);
+    close(req.err);
+    return false;
+  }
+  return true;
+}
+
+
+std::string get_server_path(void) {
+  if (const char *path = std::getenv("STATIMC_SERVER"); path && *path) {
+    return path;
+  } else if (const char *runtime = std::getenv("XDG_RUNTIME_DIR"); runtime && *runtime) {
+    return (std::filesystem::path(runtime) / "statimc.sock").string();
+  }
+  return "/tmp/statimc-" + std::to_string(getuid()) + ".sock";
+}
+
+
+void run_server(const std::string &path, int (*serve)(const ServerRequest &), int (*compile)(int, char **)) {
+  const sockaddr_un addr = get_addr(path);
+  const int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (sock < 0) {
+    panic("could not create server socket");
+  }
+
+  unlink(path.c_str());
+  if (bind(sock, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0 || listen(sock, SOMAXCONN) != 0) {
+    panic("could not listen on server socket: " + path);
+  }
+
+  // forked compiles are reaped automatically, and clients which hang up do not stop the server
+  signal(SIGCHLD, SIG_IGN);
+  signal(SIGPIPE, SIG_IGN);
+
+  while (true) {
+    const int conn = accept4(sock, nullptr, nullptr, SOCK_CLOEXEC);
+    if (conn < 0) {
+      continue;
+    }
+
+    ServerRequest req;
+    if (!recv_request(conn, req)) {
+      close(conn);
+      continue;
+    }
+
+    int status = serve(req);
+    if (status == -1) {
+      const pid_t pid = fork();
+      if (pid == 0) {
+        close(sock);
+        if (chdir(req.cwd.c_str()) != 0) {
+          _exit(1);
+        }
+        dup2(req.out, STDOUT_FILENO);
+        dup2(req.err, STDERR_FILENO);
+
+        std::vector<char *> argv;
+        for (std::string &arg : req.args) {
+          argv.push_back(arg.data());
+        }
+        argv.push_back(nullptr);
+
+        // a compile which panics exits here without a reply, which the client takes as a failure
+        status = compile(static_cast<int>(req.args.size()), argv.data());
+        std::cout.flush();
+        write_full(conn, &status, sizeof(status));
+        _exit(status);
+      }
+
+      status = pid < 0 ? 1 : -1;
+    }
+
+    if (status != -1) {
+      write_full(conn, &status, sizeof(status));
+    }
+    close(req.out);
+    close(req.err);
+    close(conn);
+  }
+}
+
+
+bool run_client(const std::string &path, int argc, char *argv[], int &status) {
+  const int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (sock < 0) {
+    return false;
+  }
+
+  const sockaddr_un addr = get_addr(path);
+  if (connect(sock, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0) {
+    close(sock);
+    return false;
+  }
+
+  std::string payload = std::filesystem::current_path().string() + '\0';
+  for (int i = 0; i < argc; i++) {
+    payload += std::string(argv[i]) + '\0';
+  }
+
+  // the length carries the output descriptors of this process, which the server writes to directly
+  std::uint32_t len = payload.size();
+  iovec iov = { &len, sizeof(len) };
+  alignas(cmsghdr) char control[CMSG_SPACE(2 * sizeof(int))] = {};
+  msghdr msg = {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(2 * sizeof(int));
+  const int fds[2] = { STDOUT_FILENO, STDERR_FILENO };
+  std::memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+  std::cout.flush();
+  if (sendmsg(sock, &msg, 0) != sizeof(len) || !write_full(sock, payload.data(), payload.size())) {
+    close(sock);
+    return false;
+  }
+
+  // the connection closes without a status if the compile panicked
+  if (!read_full(sock, &status, sizeof(status))) {
+    status = 1;
+  }
+  close(sock);
+  return true;
+}
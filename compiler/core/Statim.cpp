@@ -0,0 +1,197 @@
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../include/ast/Builder.h"
+#include "../include/ast/Unit.h"
+#include "../include/core/ASTContext.h"
+#include "../include/core/Logger.h"
+#include "../include/core/Utils.h"
+#include "../include/sema/ASTVisitor.h"
+#include "../include/statim.h"
+
+/// statim_session - The state of an embedded compile.
+///
+/// Everything a compile needs lives here, with the bookkeeping and types of sema
+/// kept by its visitor, so sessions do not see each other, even when their phases
+/// are interleaved on one thread.
+struct statim_session {
+  struct CFlags flags = { false, false, false, false, false, false };
+  std::vector<struct CFile> files;
+  std::unique_ptr<ASTContext> ctx;
+  std::unique_ptr<CrateUnit> crate;
+  std::unique_ptr<PassVisitor> visitor;
+  int phase = 0;
+  bool failed = false;
+  std::vector<Diagnostic> diags;
+  std::vector<std::pair<std::string, std::string>> outputs;
+};
+
+
+/// Runs a single phase of a session.
+static void run_phase(statim_session *session, int phase) {
+  switch (phase) {
+    case STATIM_PHASE_PARSE:
+      if (session->files.empty()) {
+        panic("no source files added to session");
+      }
+      session->ctx = std::make_unique<ASTContext>(session->flags, session->files);
+      session->crate = build_ast(session->ctx);
+      break;
+    case STATIM_PHASE_CHECK:
+      session->visitor = std::make_unique<PassVisitor>();
+      session->crate->pass(session->visitor.get());
+      break;
+    case STATIM_PHASE_LINK:
+      if (session->flags.lto) {
+        session->visitor->link(session->crate.get());
+      }
+      break;
+    case STATIM_PHASE_EMIT: {
+      const std::vector<std::string> units = session->crate->to_units();
+      const std::vector<PackageUnit *> pkgs = session->crate->get_packages();
+      for (std::size_t i = 0; i < units.size(); i++) {
+        session->outputs.push_back({ pkgs[i]->get_name(), units[i] });
+      }
+      break;
+    }
+  }
+}
+
+
+/// Returns a diagnostic of a session, or `nullptr` if the session is null or the index is out of range.
+static const Diagnostic *get_diagnostic(const statim_session *session, size_t index) {
+  return session && index < session->diags.size() ? &session->diags[index] : nullptr;
+}
+
+
+/// Returns an output of a session, or `nullptr` if the session is null or the index is out of range.
+static const std::pair<std::string, std::string> *get_output(const statim_session *session, size_t index) {
+  return session && index < session->outputs.size() ? &session->outputs[index] : nullptr;
+}
+
+
+unsigned int statim_api_version(void) {
+  return STATIM_API_VERSION;
+}
+
+
+statim_session *statim_session_create(void) {
+  return new (std::nothrow) statim_session();
+}
+
+
+void statim_session_destroy(statim_session *session) {
+  delete session;
+}
+
+
+statim_status statim_session_set_flag(statim_session *session, const char *flag) {
+  if (!session || !flag || session->phase > 0) {
+    return STATIM_MISUSE;
+  }
+
+  const std::string f = flag;
+  if (f == "-flto") {
+    session->flags.lto = true;
+  } else {
+    return STATIM_MISUSE;
+  }
+  return STATIM_OK;
+}
+
+
+statim_status statim_session_add_source(statim_session *session, const char *filename, const char *src, size_t len) {
+  if (!session || !filename || (!src && len > 0) || session->phase > 0) {
+    return STATIM_MISUSE;
+  }
+
+  struct CFile file;
+  file.filename = parse_filename(filename);
+  file.path = filename;
+  file.src = std::string(src ? src : "", len);
+  session->files.push_back(std::move(file));
+  return STATIM_OK;
+}
+
+
+statim_status statim_session_run(statim_session *session, statim_phase phase) {
+  if (!session || phase < STATIM_PHASE_PARSE || phase > STATIM_PHASE_EMIT) {
+    return STATIM_MISUSE;
+  } else if (session->failed) {
+    return STATIM_ERROR;
+  }
+
+  // panics on this thread are collected into the session and unwind to here, instead of exiting
+  std::vector<Diagnostic> *prev_sink = diag_sink;
+  diag_sink = &session->diags;
+  try {
+    while (session->phase < phase) {
+      run_phase(session, session->phase + 1);
+      session->phase++;
+    }
+  } catch (const CompileError &) {
+    session->failed = true;
+  } catch (const std::exception &e) {
+    session->diags.push_back({ true, std::string("internal compiler error: ") + e.what(), Metadata(), false });
+    session->failed = true;
+  }
+  diag_sink = prev_sink;
+  return session->failed ? STATIM_ERROR : STATIM_OK;
+}
+
+
+size_t statim_diagnostic_count(const statim_session *session) {
+  return session ? session->diags.size() : 0;
+}
+
+
+statim_severity statim_diagnostic_severity(const statim_session *session, size_t index) {
+  const Diagnostic *diag = get_diagnostic(session, index);
+  if (!diag) {
+    return STATIM_SEVERITY_NONE;
+  }
+  return diag->is_panic ? STATIM_SEVERITY_PANIC : STATIM_SEVERITY_WARN;
+}
+
+
+const char *statim_diagnostic_message(const statim_session *session, size_t index) {
+  const Diagnostic *diag = get_diagnostic(session, index);
+  return diag ? diag->msg.c_str() : nullptr;
+}
+
+
+const char *statim_diagnostic_file(const statim_session *session, size_t index) {
+  const Diagnostic *diag = get_diagnostic(session, index);
+  return diag && diag->has_meta ? diag->meta.filename.c_str() : nullptr;
+}
+
+
+unsigned int statim_diagnostic_line(const statim_session *session, size_t index) {
+  const Diagnostic *diag = get_diagnostic(session, index);
+  return diag && diag->has_meta ? diag->meta.line_n : 0;
+}
+
+
+unsigned int statim_diagnostic_col(const statim_session *session, size_t index) {
+  const Diagnostic *diag = get_diagnostic(session, index);
+  return diag && diag->has_meta ? diag->meta.col_n : 0;
+}
+
+
+size_t statim_output_count(const statim_session *session) {
+  return session ? session->outputs.size() : 0;
+}
+
+
+const char *statim_output_name(const statim_session *session, size_t index) {
+  const std::pair<std::string, std::string> *output = get_output(session, index);
+  return output ? output->first.c_str() : nullptr;
+}
+
+
+const char *statim_output(const statim_session *session, size_t index) {
+  const std::pair<std::string, std::string> *output = get_output(session, index);
+  return output ? output->second.c_str() : nullptr;
+}
@@ -0,0 +1,140 @@
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../include/core/Logger.h"
+#include "../include/core/Manifest.h"
+#include "../include/core/Watch.h"
+
+/// The time the source tree must be quiet for before a rebuild starts, in milliseconds.
+static constexpr int quiet_ms = 30;
+
+/// The events which may change the crate.
+static constexpr uint32_t watch_mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE | IN_DELETE_SELF;
+
+/// Watches a directory and all directories under it.
+static void add_watches(int fd, const std::filesystem::path &dir, std::map<int, std::filesystem::path> &dirs) {
+  const int wd = inotify_add_watch(fd, dir.c_str(), watch_mask | IN_ONLYDIR);
+  if (wd < 0) {
+    return;
+  }
+  dirs[wd] = dir;
+
+  std::error_code ec;
+  for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(dir, ec)) {
+    if (entry.is_directory()) {
+      add_watches(fd, entry.path(), dirs);
+    }
+  }
+}
+
+
+/// Watches the current directory, and the search roots of its manifest, which may lie outside of it.
+///
+/// A malformed manifest is left for the rebuild to report, and only the current directory is watched until it is
+/// fixed. Directories which are already watched keep their watch.
+static void watch_crate(int fd, std::map<int, std::filesystem::path> &dirs) {
+  const std::filesystem::path cwd = std::filesystem::current_path();
+  add_watches(fd, cwd, dirs);
+
+  std::vector<Diagnostic> diags;
+  std::vector<Diagnostic> *prev_sink = diag_sink;
+  diag_sink = &diags;
+  try {
+    Manifest manifest;
+    if (load_manifest(cwd, manifest)) {
+      for (const std::filesystem::path &root : manifest.roots) {
+        add_watches(fd, root, dirs);
+      }
+    }
+  } catch (const CompileError &) {}
+  diag_sink = prev_sink;
+}
+
+
+/// Reads the pending events of an inotify descriptor.
+/// @returns `true` if a source file, manifest or directory of the tree changed.
+static bool read_events(int fd, std::map<int, std::filesystem::path> &dirs) {
+  alignas(inotify_event) char buf[1 << 14];
+  const ssize_t len = read(fd, buf, sizeof(buf));
+
+  bool changed = false;
+  for (ssize_t i = 0; i < len; ) {
+    const inotify_event *ev = reinterpret_cast<const inotify_event *>(buf + i);
+    i += sizeof(inotify_event) + ev->len;
+
+    if (ev->mask & (IN_DELETE_SELF | IN_IGNORED)) {
+      dirs.erase(ev->wd);
+      continue;
+    } else if (ev->len == 0 || dirs.find(ev->wd) == dirs.end()) {
+      continue;
+    }
+
+    const std::filesystem::path path = dirs.at(ev->wd) / ev->name;
+    if (ev->mask & IN_ISDIR) {
+      // new directories may already hold sources by the time they are watched
+      if (ev->mask & (IN_CREATE | IN_MOVED_TO)) {
+        add_watches(fd, path, dirs);
+      }
+      changed = true;
+    } else if (path.filename() == "statim.toml") {
+      // the roots of the manifest may have moved
+      watch_crate(fd, dirs);
+      changed = true;
+    } else if (path.extension() == ".statim") {
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+
+/// Compiles the crate in a forked child, and prints how long it took.
+static void rebuild(int (*compile)(int, char **), int argc, char *argv[]) {
+  const auto start = std::chrono::steady_clock::now();
+  std::cout.flush();
+
+  int status = 1;
+  const pid_t pid = fork();
+  if (pid == 0) {
+    const int code = compile(argc, argv);
+    std::cout.flush();
+    _exit(code);
+  } else if (pid > 0) {
+    waitpid(pid, &status, 0);
+    status = WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+  }
+
+  const auto ms = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0;
+  fprintf(stderr, "statimc: watch: %s in %.1f ms\n", status == 0 ? "rebuilt" : "failed", ms);
+}
+
+
+void run_watch(int (*compile)(int, char **), int argc, char *argv[]) {
+  const int fd = inotify_init1(IN_CLOEXEC);
+  if (fd < 0) {
+    panic("could not start watching the source tree");
+  }
+
+  std::map<int, std::filesystem::path> dirs;
+  watch_crate(fd, dirs);
+  rebuild(compile, argc, argv);
+
+  while (true) {
+    pollfd pfd = { fd, POLLIN, 0 };
+    if (poll(&pfd, 1, -1) <= 0 || !read_events(fd, dirs)) {
+      continue;
+    }
+
+    // coalesce bursts of saves into a single rebuild
+    while (poll(&pfd, 1, quiet_ms) > 0) {
+      read_events(fd, dirs);
+    }
+    rebuild(compile, argc, argv);
+  }
+}
@@ -245,13 +245,19 @@ private:
   std::vector<std::unique_ptr<ParamVarDecl>> params;
   std::unique_ptr<Stmt> body;
   bool priv;
+  bool async;
+  unsigned int suspend_points;
+  std::vector<NamedDecl *> frame;
+  bool inlined;
 
 public:
   FunctionDecl(const std::string &name, Type *T, std::vector<std::unique_ptr<ParamVarDecl>> params, const Metadata &meta) 
-    : NamedDecl(name), ScopedDecl(nullptr), T(T), meta(meta), params(std::move(params)), body(nullptr), priv(name == "main" ? true : false) {};
+    : NamedDecl(name), ScopedDecl(nullptr), T(T), meta(meta), params(std::move(params)), body(nullptr), priv(name == "main" ? true : false),
+    async(false), suspend_points(0), frame(), inlined(false) {};
   FunctionDecl(const std::string &name, Type *T, std::vector<std::unique_ptr<ParamVarDecl>> params, std::unique_ptr<Stmt> body, 
     std::shared_ptr<Scope> scope, const Metadata &meta)
-    : NamedDecl(name), ScopedDecl(scope), T(T), meta(meta), params(std::move(params)), body(std::move(body)), priv(name == "main" ? true : false) {};
+    : NamedDecl(name), ScopedDecl(scope), T(T), meta(meta), params(std::move(params)), body(std::move(body)), priv(name == "main" ? true : false),
+    async(false), suspend_points(0), frame(), inlined(false) {};
   void pass(ASTVisitor *visitor) override { visitor->visit(this); }
   inline const Type* get_type() const { return T; }
   inline void set_type(const Type *T) { this->T = T; }
@@ -288,6 +294,34 @@ public:
   // Set this function declaration as public.
   inline void set_pub() override { priv = false; }
 
+  /// Returns true if this function is async, and is lowered to a resumable state machine.
+  inline bool is_async() const { return async; }
+
+  /// Set this function declaration as async.
+  inline void set_async() { async = true; }
+
+  /// Returns the number of await points this async function may suspend at.
+  inline unsigned int get_suspend_points() const { return suspend_points; }
+
+  /// Sets the number of await points this async function may suspend at.
+  inline void set_suspend_points(unsigned int n) { suspend_points = n; }
+
+  /// Returns the locals of this async function that live across an await, and so are stored in its state machine frame.
+  inline const std::vector<NamedDecl *> get_frame() const { return frame; }
+
+  /// Add a local to the state machine frame of this async function, if it is not already in it.
+  inline void add_frame_decl(NamedDecl *d) {
+    if (std::find(frame.begin(), frame.end(), d) == frame.end()) {
+      frame.push_back(d);
+    }
+  }
+
+  /// Returns true if this function is inlined into its only call site.
+  inline bool is_inline() const { return inlined; }
+
+  /// Set this function to be inlined into its only call site.
+  inline void set_inline() { inlined = true; }
+
   /// Returns a string representation of this function declaration.
   const std::string to_string() override;
 };
@@ -444,6 +478,14 @@ public:
     return nullptr;
   }
 
+  /// Removes a method from this implementation declaration.
+  inline void remove_method(FunctionDecl *method) {
+    methods.erase(std::remove_if(
+      methods.begin(),
+      methods.end(),
+      [method](const std::unique_ptr<FunctionDecl> &m) { return m.get() == method; }), methods.end());
+  }
+
   /// Returns the name of the trait this declaration implements, or an empty string otherwise.
   inline const std::string trait() const { return is_trait() ? _trait : ""; }
 
@@ -469,10 +511,13 @@ private:
   const Type *T;
   const Metadata meta;
   bool priv;
+  unsigned int align;
+  bool cache_padded;
+  unsigned long offset;
 
 public:
-  FieldDecl(const std::string &name, const Type *T, const Metadata &meta) 
-    : NamedDecl(name), T(T), meta(meta), priv(false) {};
+  FieldDecl(const std::string &name, const Type *T, const Metadata &meta)
+    : NamedDecl(name), T(T), meta(meta), priv(false), align(0), cache_padded(false), offset(0) {};
   void pass(ASTVisitor *visitor) override { visitor->visit(this); }
   inline const Type* get_type() const { return T; }
   inline void set_type(const Type *T) { this->T = T; }
@@ -487,6 +532,24 @@ public:
   // Set this function declaration as public.
   inline void set_pub() override { priv = false; }
 
+  /// Returns the alignment requested by an `#[align(N)]` attribute, or 0 if there is none.
+  inline unsigned int get_align() const { return align; }
+
+  /// Set the alignment of this field, by the `#[align(N)]` attribute.
+  inline void set_align(unsigned int align) { this->align = align; }
+
+  /// Returns true if this field is placed on its own cache line.
+  inline bool is_cache_padded() const { return cache_padded; }
+
+  /// Set this field to be placed on its own cache line, by the `#[cache_padded]` attribute.
+  inline void set_cache_padded() { cache_padded = true; }
+
+  /// Returns the offset of this field in its struct, in bytes.
+  inline unsigned long get_offset() const { return offset; }
+
+  /// Set the offset of this field in its struct, in bytes.
+  inline void set_offset(unsigned long offset) { this->offset = offset; }
+
   /// Returns a string representation of this struct fields.
   const std::string to_string() override;
 };
@@ -500,11 +563,14 @@ private:
   std::shared_ptr<Scope> scope;
   std::vector<std::string> impls;
   bool priv;
+  bool soa;
+  unsigned int align;
+  unsigned long size;
   const Metadata meta;
 
 public:
   StructDecl(const std::string &name, std::vector<std::unique_ptr<FieldDecl>> fields, std::shared_ptr<Scope> scope, const Metadata &meta)
-    : ScopedDecl(scope), TypeDecl(name, nullptr), fields(std::move(fields)), priv(false), impls(), meta(meta) {};
+    : ScopedDecl(scope), TypeDecl(name, nullptr), fields(std::move(fields)), impls(), priv(false), soa(false), align(0), size(0), meta(meta) {};
   void pass(ASTVisitor *visitor) override { visitor->visit(this); }
   inline const Metadata get_meta() const override { return meta; }
 
@@ -552,6 +618,24 @@ public:
   /// Add a trait implementation to this struct.
   inline void add_impl(const std::string &trait) { impls.push_back(trait); }
 
+  /// Returns true if arrays and vectors of this struct store it field by field, as a struct of arrays.
+  inline bool is_soa() const { return soa; }
+
+  /// Set this struct to be stored field by field in arrays and vectors, by the `#[soa]` attribute.
+  inline void set_soa() { soa = true; }
+
+  /// Returns the alignment of this struct in bytes, or 0 if it is not yet known.
+  inline unsigned int get_align() const { return align; }
+
+  /// Set the alignment of this struct in bytes, by the `#[align(N)]` attribute or its layout.
+  inline void set_align(unsigned int align) { this->align = align; }
+
+  /// Returns the size of this struct in bytes.
+  inline unsigned long get_size() const { return size; }
+
+  /// Set the size of this struct in bytes.
+  inline void set_size(unsigned long size) { this->size = size; }
+
   /// Returns a string representation of this struct declaration.
   const std::string to_string() override;
 };
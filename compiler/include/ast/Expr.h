@@ -85,13 +85,33 @@ typedef enum {
 } BinaryOp;
 
 
+/// BoundsCheck - Enumeration of ways the bounds of an index are checked.
+typedef enum {
+  /// Checked on every access.
+  BoundsChecked,
+
+  /// Checked once before the enclosing loop.
+  BoundsHoisted,
+
+  /// Proven in bounds at compile time.
+  BoundsElided,
+} BoundsCheck;
+
+
 /// Returns true if the given binary operator is a (re)assignment operator.
-static bool is_assignment_op(BinaryOp op) {
+inline bool is_assignment_op(BinaryOp op) {
   return op == BinaryOp::Assign || op == BinaryOp::AddAssign || op == BinaryOp::SubAssign || \
     op == BinaryOp::StarAssign || op == BinaryOp::SlashAssign;
 }
 
 
+/// Returns true if the given binary operator is a comparison or logical operator, and so results in a boolean.
+inline bool is_comparison_op(BinaryOp op) {
+  return op == BinaryOp::IsEq || op == BinaryOp::IsNotEq || op == BinaryOp::LogicAnd || op == BinaryOp::LogicOr || \
+    op == BinaryOp::Lt || op == BinaryOp::LtEquals || op == BinaryOp::Gt || op == BinaryOp::GtEquals;
+}
+
+
 /// Base class for expressions; statements that may have a value and type.
 class Expr : public Stmt
 {
@@ -172,28 +192,36 @@ public:
 
 /// IntegerLiteral - Represents an integer literal expression.
 ///
-/// @example `0`, `512`, `1024`
+/// Literals without a type suffix adapt to the integer type they are used as,
+/// so long as their value fits in it.
+///
+/// @example `0`, `512`, `1024`, `255u8`
 class IntegerLiteral final : public Expr
 {
 private:
-  const long value;
+  const long long value;
   const bool signedness;
+  const bool suffixed;
   const Type *T;
   const Metadata meta;
 
 public:
-  IntegerLiteral(int value, const Type *T, const Metadata &meta) 
-    : value(value), signedness(value < 0), T(T), meta(meta){};
+  IntegerLiteral(long long value, bool signedness, bool suffixed, const Type *T, const Metadata &meta)
+    : value(value), signedness(signedness), suffixed(suffixed), T(T), meta(meta){};
   void pass(ASTVisitor *visitor) override { visitor->visit(this); }
   inline const Type* get_type() const override { return T; }
+  inline void set_type(const Type *T) { this->T = T; }
   const Metadata get_meta() const override { return meta; }
 
-  /// Gets the value of this integer expression.
-  inline int get_value() const { return value; }
+  /// Gets the value of this integer expression. Values above the range of `i64` wrap, and are only valid as `u64`.
+  inline long long get_value() const { return value; }
 
-  /// Gets the signedness of this integer expression.
+  /// Gets the signedness of this integer expression, which is true if it was written negative.
   inline bool is_signed() const { return signedness; }
 
+  /// Returns true if this literal was written with a type suffix.
+  inline bool is_suffixed() const { return suffixed; }
+
   /// Returns a string representation of this integer expression.
   const std::string to_string() override;
 };
@@ -206,16 +234,21 @@ class FPLiteral final : public Expr
 {
 private:
   const double value;
+  const bool suffixed;
   const Type *T;
   const Metadata meta;
 
 public:
-  FPLiteral(double value, const Type *T, const Metadata &meta) \
-    : value(value), T(T), meta(meta){};
+  FPLiteral(double value, bool suffixed, const Type *T, const Metadata &meta) \
+    : value(value), suffixed(suffixed), T(T), meta(meta){};
   void pass(ASTVisitor *visitor) override { visitor->visit(this); }
   inline const Type* get_type() const override { return T; }
+  inline void set_type(const Type *T) { this->T = T; }
   const Metadata get_meta() const override { return meta; }
 
+  /// Returns true if this literal was written with a type suffix.
+  inline bool is_suffixed() const { return suffixed; }
+
   /// Gets the value of this floating point expression.
   inline double get_value() const { return value; }
 
@@ -251,17 +284,21 @@ public:
 
 /// StringLiteral - Represents a string literal expression.
 ///
+/// String literals are interned into a crate-wide pool, and refer to their
+/// pooled copy by id.
+///
 /// @example `"hello, world"`, `"foo"`, `"bar"`
 class StringLiteral final : public Expr
 {
 private:
   const std::string value;
+  const unsigned int id;
   const Type *T;
   const Metadata meta;
 
 public:
-  StringLiteral(const std::string &value, const Type *T, const Metadata &meta) 
-    : value(value), T(T), meta(meta){};
+  StringLiteral(const std::string &value, const unsigned int id, const Type *T, const Metadata &meta) 
+    : value(value), id(id), T(T), meta(meta){};
   void pass(ASTVisitor *visitor) override { visitor->visit(this); }
   inline const Type* get_type() const override { return T; }
   const Metadata get_meta() const override { return meta; }
@@ -269,6 +306,12 @@ public:
   /// Gets the value of this string expression.
   inline const std::string get_value() const { return value; }
 
+  /// Gets the id of this string expression in the literal pool.
+  inline unsigned int get_id() const { return id; }
+
+  /// Returns true if this string fits inline in a `str` value, and false otherwise.
+  inline bool is_inline() const { return StrLayout::is_inline(value.size()); }
+
   /// Returns a string representation of this string expression.
   const std::string to_string() override;
 };
@@ -469,6 +512,175 @@ public:
 };
 
 
+/// VectorExpr - Represents the construction of a SIMD vector value.
+///
+/// A vector is constructed from a value for each of its lanes, or from a
+/// single value which is splat across all of them.
+///
+/// @example `f32x4(1.0, 2.0, 3.0, 4.0)`, `i32x8(0)`
+class VectorExpr final : public Expr
+{
+private:
+  std::vector<std::unique_ptr<Expr>> lanes;
+  const Type *T;
+  const Metadata meta;
+
+public:
+  VectorExpr(std::vector<std::unique_ptr<Expr>> lanes, const Type *T, const Metadata &meta)
+    : lanes(std::move(lanes)), T(T), meta(meta){};
+  void pass(ASTVisitor *visitor) override { visitor->visit(this); }
+  inline const Type* get_type() const override { return T; }
+  inline const Metadata get_meta() const override { return meta; }
+
+  /// Gets the number of lane values given to this vector.
+  inline std::size_t get_num_lanes() const { return lanes.size(); }
+
+  /// Gets the lane value at position <n>.
+  inline Expr *get_lane(std::size_t n) { return lanes.at(n).get(); }
+
+  /// Returns true if a single value is splat across all lanes.
+  inline bool is_splat() const { return lanes.size() == 1; }
+
+  /// Returns a string representation of this vector expression.
+  const std::string to_string() override;
+};
+
+
+/// ArrayExpr - Represents an array literal.
+///
+/// @example `[1, 2, 3]`, `[a, b]`
+class ArrayExpr final : public Expr
+{
+private:
+  std::vector<std::unique_ptr<Expr>> elements;
+  const Type *T;
+  const Metadata meta;
+
+public:
+  ArrayExpr(std::vector<std::unique_ptr<Expr>> elements, const Metadata &meta)
+    : elements(std::move(elements)), T(nullptr), meta(meta){};
+  void pass(ASTVisitor *visitor) override { visitor->visit(this); }
+  inline const Type* get_type() const override { return T; }
+  inline void set_type(const Type *T) { this->T = T; }
+  inline const Metadata get_meta() const override { return meta; }
+
+  /// Gets the number of elements in this array.
+  inline std::size_t get_num_elements() const { return elements.size(); }
+
+  /// Gets the element at position <n>.
+  inline Expr *get_element(std::size_t n) { return elements.at(n).get(); }
+
+  /// Returns a string representation of this array expression.
+  const std::string to_string() override;
+};
+
+
+/// MapExpr - Represents a map literal.
+///
+/// @example `["a": 1, "b": 2]`
+class MapExpr final : public Expr
+{
+private:
+  std::vector<std::unique_ptr<Expr>> keys;
+  std::vector<std::unique_ptr<Expr>> values;
+  const Type *T;
+  const Metadata meta;
+
+public:
+  MapExpr(std::vector<std::unique_ptr<Expr>> keys, std::vector<std::unique_ptr<Expr>> values, const Metadata &meta)
+    : keys(std::move(keys)), values(std::move(values)), T(nullptr), meta(meta){};
+  void pass(ASTVisitor *visitor) override { visitor->visit(this); }
+  inline const Type* get_type() const override { return T; }
+  inline void set_type(const Type *T) { this->T = T; }
+  inline const Metadata get_meta() const override { return meta; }
+
+  /// Gets the number of entries in this map.
+  inline std::size_t get_num_entries() const { return keys.size(); }
+
+  /// Gets the key of the entry at position <n>.
+  inline Expr *get_key(std::size_t n) { return keys.at(n).get(); }
+
+  /// Gets the value of the entry at position <n>.
+  inline Expr *get_value(std::size_t n) { return values.at(n).get(); }
+
+  /// Returns a string representation of this map expression.
+  const std::string to_string() override;
+};
+
+
+/// IndexExpr - Represents indexing into an array, slice or string.
+///
+/// @example `a[0]`, `buf[i]`
+class IndexExpr final : public Expr
+{
+private:
+  std::unique_ptr<Expr> base;
+  std::unique_ptr<Expr> index;
+  const Type *T;
+  const Metadata meta;
+  BoundsCheck bounds;
+
+public:
+  IndexExpr(std::unique_ptr<Expr> base, std::unique_ptr<Expr> index, const Metadata &meta)
+    : base(std::move(base)), index(std::move(index)), T(nullptr), meta(meta), bounds(BoundsChecked){};
+  void pass(ASTVisitor *visitor) override { visitor->visit(this); }
+  inline const Type* get_type() const override { return T; }
+  inline void set_type(const Type *T) { this->T = T; }
+  inline const Metadata get_meta() const override { return meta; }
+
+  /// Gets the indexed expression.
+  inline Expr *get_base() { return base.get(); }
+
+  /// Gets the index expression.
+  inline Expr *get_index() { return index.get(); }
+
+  /// Gets how the bounds of this index are checked.
+  inline BoundsCheck get_bounds() const { return bounds; }
+
+  /// Sets how the bounds of this index are checked.
+  inline void set_bounds(BoundsCheck bounds) { this->bounds = bounds; }
+
+  /// Returns a string representation of this index expression.
+  const std::string to_string() override;
+};
+
+
+/// SliceExpr - Represents borrowing a range of an array, slice or string as a slice.
+///
+/// Either bound may be left out, to slice from the start or to the end.
+///
+/// @example `a[1..3]`, `buf[i..]`, `s[..]`
+class SliceExpr final : public Expr
+{
+private:
+  std::unique_ptr<Expr> base;
+  std::unique_ptr<Expr> lo;
+  std::unique_ptr<Expr> hi;
+  const Type *T;
+  const Metadata meta;
+
+public:
+  SliceExpr(std::unique_ptr<Expr> base, std::unique_ptr<Expr> lo, std::unique_ptr<Expr> hi, const Metadata &meta)
+    : base(std::move(base)), lo(std::move(lo)), hi(std::move(hi)), T(nullptr), meta(meta){};
+  void pass(ASTVisitor *visitor) override { visitor->visit(this); }
+  inline const Type* get_type() const override { return T; }
+  inline void set_type(const Type *T) { this->T = T; }
+  inline const Metadata get_meta() const override { return meta; }
+
+  /// Gets the sliced expression.
+  inline Expr *get_base() { return base.get(); }
+
+  /// Gets the lower bound of this slice, or `nullptr` if it starts at the beginning.
+  inline Expr *get_lo() { return lo.get(); }
+
+  /// Gets the upper bound of this slice, or `nullptr` if it runs to the end.
+  inline Expr *get_hi() { return hi.get(); }
+
+  /// Returns a string representation of this slice expression.
+  const std::string to_string() override;
+};
+
+
 /// MemberExpr - Represents member access expressions.
 ///
 /// @example `foo.bar`, `baz.qux`
@@ -478,11 +690,12 @@ private:
   std::unique_ptr<Expr> base;
   const std::string member;
   const Type *T;
+  bool soa;
   const Metadata meta;
 
 public:
   MemberExpr(std::unique_ptr<Expr> base, const std::string &member, const Metadata &meta)
-    : base(std::move(base)), member(member), T(nullptr), meta(meta){};
+    : base(std::move(base)), member(member), T(nullptr), soa(false), meta(meta){};
   void pass(ASTVisitor *visitor) override { visitor->visit(this); }
   const Metadata get_meta() const override { return meta; }
 
@@ -498,6 +711,13 @@ public:
   /// Gets the member of this member access expression.
   inline const std::string get_member() const { return member; }
 
+  /// Returns true if this accesses a field of an element of struct-of-arrays storage, and so is lowered to an
+  /// index into the column of the field, `a.field[i]`, rather than into the elements.
+  inline bool is_soa() const { return soa; }
+
+  /// Set this member access to read from the column of its field.
+  inline void set_soa() { soa = true; }
+
   /// Returns a string representation of this member access expression.
   const std::string to_string() override;
 };
@@ -529,6 +749,148 @@ public:
 };
 
 
+/// AwaitExpr - Represents suspending an async function until an async call completes.
+///
+/// Each await is a resume point of the enclosing async function's state machine.
+///
+/// @example `await foo()`, `await bar.baz(x)`
+class AwaitExpr final : public Expr
+{
+private:
+  std::unique_ptr<Expr> expr;
+  const Type *T;
+  const Metadata meta;
+  unsigned int state;
+
+public:
+  AwaitExpr(std::unique_ptr<Expr> expr, const Metadata &meta)
+    : expr(std::move(expr)), T(this->expr->get_type()), meta(meta), state(0){};
+  void pass(ASTVisitor *visitor) override { visitor->visit(this); }
+  inline const Type* get_type() const override { return T; }
+  inline void set_type(const Type *T) { this->T = T; }
+  const Metadata get_meta() const override { return meta; }
+
+  /// Gets the awaited expression.
+  inline Expr *get_expr() { return expr.get(); }
+
+  /// Gets the state machine state this await resumes into.
+  inline unsigned int get_state() const { return state; }
+
+  /// Sets the state machine state this await resumes into.
+  inline void set_state(unsigned int state) { this->state = state; }
+
+  /// Returns a string representation of this await expression.
+  const std::string to_string() override;
+};
+
+
+/// CastExpr - Represents an explicit conversion between primitive types.
+///
+/// @example `x as u8`, `len as f64`
+class CastExpr final : public Expr
+{
+private:
+  std::unique_ptr<Expr> expr;
+  const Type *T;
+  const Metadata meta;
+
+public:
+  CastExpr(std::unique_ptr<Expr> expr, const Type *T, const Metadata &meta)
+    : expr(std::move(expr)), T(T), meta(meta){};
+  void pass(ASTVisitor *visitor) override { visitor->visit(this); }
+  inline const Type* get_type() const override { return T; }
+  const Metadata get_meta() const override { return meta; }
+
+  /// Gets the expression being converted.
+  inline Expr *get_expr() { return expr.get(); }
+
+  /// Returns a string representation of this cast expression.
+  const std::string to_string() override;
+};
+
+
+/// SpawnExpr - Represents running a function call as a task on the scheduler.
+///
+/// Arguments are evaluated before the task is spawned, and the expression
+/// evaluates to a handle which can be joined for the result of the call.
+///
+/// @example `spawn foo()`, `spawn fib(n - 1)`
+class SpawnExpr final : public Expr
+{
+private:
+  std::unique_ptr<Expr> expr;
+  const Type *T;
+  const Metadata meta;
+
+public:
+  SpawnExpr(std::unique_ptr<Expr> expr, const Metadata &meta)
+    : expr(std::move(expr)), T(nullptr), meta(meta){};
+  void pass(ASTVisitor *visitor) override { visitor->visit(this); }
+  inline const Type* get_type() const override { return T; }
+  inline void set_type(const Type *T) { this->T = T; }
+  const Metadata get_meta() const override { return meta; }
+
+  /// Gets the spawned call expression.
+  inline Expr *get_expr() { return expr.get(); }
+
+  /// Returns a string representation of this spawn expression.
+  const std::string to_string() override;
+};
+
+
+/// PrintExpr - Represents a call to the builtin `print` or `println`.
+///
+/// The format string is split around its placeholders at compile time, so
+/// printing emits each literal piece and argument straight into the output
+/// buffer of the thread, with no format parsing at runtime. Placeholders are
+/// `{}` for any primitive value, `{:x}` for an integer in hex, and `{:.N}`
+/// for a float with `N` digits after the point. Buffers are flushed in large
+/// writes, and when their thread exits.
+///
+/// @example `println("{} of {}", i, n)`
+class PrintExpr final : public Expr
+{
+private:
+  const std::string format;
+  const std::vector<std::string> pieces;
+  const std::vector<unsigned int> ids;
+  const std::vector<std::string> specs;
+  std::vector<std::unique_ptr<Expr>> args;
+  const bool newline;
+  const Metadata meta;
+
+public:
+  PrintExpr(const std::string &format, const std::vector<std::string> &pieces, const std::vector<unsigned int> &ids,
+            const std::vector<std::string> &specs, std::vector<std::unique_ptr<Expr>> args, bool newline,
+            const Metadata &meta)
+    : format(format), pieces(pieces), ids(ids), specs(specs), args(std::move(args)), newline(newline), meta(meta){};
+  void pass(ASTVisitor *visitor) override { visitor->visit(this); }
+  inline const Type* get_type() const override { return nullptr; }
+  const Metadata get_meta() const override { return meta; }
+
+  /// Gets the literal pieces of the format string, one more than there are placeholders.
+  inline const std::vector<std::string> &get_pieces() const { return pieces; }
+
+  /// Gets the ids of the literal pieces in the literal pool.
+  inline const std::vector<unsigned int> &get_ids() const { return ids; }
+
+  /// Gets the specifier of each placeholder, which is empty for `{}`.
+  inline const std::vector<std::string> &get_specs() const { return specs; }
+
+  /// Gets the number of arguments of this print.
+  inline int get_num_args() const { return args.size(); }
+
+  /// Gets the argument at position <n>.
+  inline Expr *get_arg(std::size_t n) { return args.at(n).get(); }
+
+  /// Returns true if this print ends with a newline.
+  inline bool is_newline() const { return newline; }
+
+  /// Returns a string representation of this print expression.
+  const std::string to_string() override;
+};
+
+
 /// ThisExpr - Represents a reference to the current instance.
 ///
 /// @example `this`
@@ -4,6 +4,7 @@
 /// Statement AST nodes.
 /// Copyright 2024 Nick Marino (github.com/nwmarino)
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -15,6 +16,7 @@
 class Scope;
 class Decl;
 class Expr;
+class BinaryExpr;
 
 /// Base class for a statement representation.
 class Stmt
@@ -201,6 +203,75 @@ public:
 };
 
 
+/// ForStmt - Represents a ranged for statement.
+///
+/// For statements iterate an induction variable over the half-open range `[lo, hi)`.
+/// Parallel for statements split the range across worker threads, and may only write
+/// to captured mutable variables through reductions.
+class ForStmt final : public Stmt
+{
+private:
+  std::unique_ptr<Decl> var;
+  std::unique_ptr<Expr> lo;
+  std::unique_ptr<Expr> hi;
+  std::unique_ptr<Stmt> body;
+  std::shared_ptr<Scope> scope;
+  std::vector<BinaryExpr *> reductions;
+  std::vector<std::string> hoisted;
+  std::vector<std::string> columns;
+  const bool parallel;
+  const Metadata meta;
+
+public:
+  ForStmt(std::unique_ptr<Decl> var, std::unique_ptr<Expr> lo, std::unique_ptr<Expr> hi, std::unique_ptr<Stmt> body,
+    std::shared_ptr<Scope> scope, bool parallel, const Metadata &meta)
+    : var(std::move(var)), lo(std::move(lo)), hi(std::move(hi)), body(std::move(body)), scope(scope), reductions(),
+    parallel(parallel), meta(meta){};
+  void pass(ASTVisitor *visitor) override { visitor->visit(this); }
+  inline Decl* get_var() const { return var.get(); }
+  inline Expr* get_lo() const { return lo.get(); }
+  inline Expr* get_hi() const { return hi.get(); }
+  inline Stmt* get_body() const { return body.get(); }
+  const Metadata get_meta() const override { return meta; }
+
+  /// Returns the scope of the induction variable.
+  inline std::shared_ptr<Scope> get_scope() const { return scope; }
+
+  /// Determine if this for statement is parallel.
+  inline bool is_parallel() const { return parallel; }
+
+  /// Returns the reductions over captured variables in this for statement.
+  inline const std::vector<BinaryExpr *> get_reductions() const { return reductions; }
+
+  /// Add a reduction over a captured variable to this for statement.
+  inline void add_reduction(BinaryExpr *e) { reductions.push_back(e); }
+
+  /// Gets the names of the arrays and slices whose bounds checks are hoisted in front of this loop.
+  inline const std::vector<std::string> get_hoisted() const { return hoisted; }
+
+  /// Hoist the bounds checks on indexing the named array or slice by the induction variable in front of this loop.
+  inline void add_hoisted(const std::string &name) {
+    if (std::find(hoisted.begin(), hoisted.end(), name) == hoisted.end()) {
+      hoisted.push_back(name);
+    }
+  }
+
+  /// Gets the columns of struct-of-arrays storage, named `<array>.<field>`, which this loop walks by its
+  /// induction variable. Each column is contiguous, so it can be streamed and vectorized on its own.
+  inline const std::vector<std::string> get_columns() const { return columns; }
+
+  /// Add a column of struct-of-arrays storage walked by the induction variable of this loop.
+  inline void add_column(const std::string &name) {
+    if (std::find(columns.begin(), columns.end(), name) == columns.end()) {
+      columns.push_back(name);
+    }
+  }
+
+  /// Returns a string representation of this for statement.
+  const std::string to_string() override;
+};
+
+
 /// BreakStmt - Represents a break statement.
 ///
 /// Break statements are used to exit a loop statement prematurely.
@@ -4,6 +4,7 @@
 /// Translation unit related AST nodes.
 /// Copyright 2024 Nick Marino (github.com/nwmarino)
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -45,6 +46,14 @@ public:
     return decls;
   }
 
+  /// Removes a declaration from this package unit.
+  inline void remove_decl(Decl *d) {
+    decls.erase(std::remove_if(
+      decls.begin(),
+      decls.end(),
+      [d](const std::unique_ptr<Decl> &decl) { return decl.get() == d; }), decls.end());
+  }
+
   /// Gets the name of this package unit.
   inline const std::string get_name() const { return name; }
 
@@ -91,6 +100,9 @@ public:
 
   /// Returns a string representation of this crate unit.
   const std::string to_string() override;
+
+  /// Returns the string representation of each package of this crate unit, in package order.
+  const std::vector<std::string> to_units();
 };
 
 #endif  // UNIT_STATIMC_H
@@ -6,6 +6,7 @@
 
 #include <map>
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include "Type.h"
@@ -20,15 +21,20 @@ struct CFlags {
   bool emit_llvm_ir;
   bool emit_asm;
   bool pass_one;
+  bool lto;
+  bool cache;
 };
 
 
 /// CFile - An input file wrapper for the compiler.
 ///
 /// The CFile struct contains the filename and path of an input file that is being compiled.
+/// Files which were already read, or are open in an editor with unsaved changes, carry their contents,
+/// which are compiled instead of reading the file on disk.
 struct CFile {
   std::string filename;
   std::string path;
+  std::optional<std::string> src;
 };
 
 
@@ -49,6 +55,7 @@ private:
   std::string _top_impl;
   bool _past_base;
   std::map<const std::string, Type *> type_table;
+  std::map<const std::string, unsigned int> str_pool;
 
 public:
   ASTContext(struct CFlags flags, std::vector<struct CFile> input);
@@ -80,12 +87,47 @@ public:
   inline bool past_base(void) const { return _past_base; }
   /// Sets the past base flag.
   void set_past_base(bool past);
+  /// Returns true if a type by the given name is in the type table.
+  [[nodiscard]]
+  inline bool has_type(const std::string &name) const { return type_table.find(name) != type_table.end(); }
+
   /// Resolves a type by name. Returns a `TypeRef` object if the type is not found.
   [[nodiscard]]
   Type* resolve_type(const std::string &name);
+  /// Resolves a builtin generic type by name and type parameters, for example `task<i64>`. Instances are shared
+  /// between equal parameter lists.
+  /// @returns A pointer to the type, or `nullptr` if no such generic type exists.
+  [[nodiscard]]
+  Type* resolve_generic_type(const std::string &name, const std::vector<const Type *> &params);
+  /// Resolves an array type by element type and length, for example `[i32; 4]`. Instances are shared
+  /// between equal element types and lengths.
+  [[nodiscard]]
+  Type* resolve_array_type(const Type *T, unsigned int len);
+
+  /// Resolves a channel type by element type and capacity, for example `chan<i64; 1024>`. Instances are
+  /// shared between equal element types and capacities.
+  [[nodiscard]]
+  Type* resolve_chan_type(const Type *T, unsigned int cap);
+
+  /// Resolves a rune type by the type it points to, for example `#i64`. Instances are shared between equal
+  /// pointee types.
+  [[nodiscard]]
+  Type* resolve_rune_type(const Type *T);
+
+  /// Resolves a slice type by element type, for example `[u8]`. Instances are shared between equal element types.
+  [[nodiscard]]
+  Type* resolve_slice_type(const Type *T);
+
   /// Declares a type in the type table. Used for source defined types. Panics if the type already exists.
   /// @returns A pointer to the new type.
   Type* declare_type(const std::string &name, Type *T);
+  /// Interns a string literal into the crate-wide literal pool, so that equal literals across all packages
+  /// share a single read-only copy.
+  /// @returns The id of the pooled literal.
+  unsigned int intern_str(const std::string &value);
+  /// Gets the crate-wide string literal pool, keyed by literal value.
+  [[nodiscard]]
+  inline const std::map<const std::string, unsigned int> &get_str_pool(void) const { return str_pool; }
 };
 
 #endif  // ASTCONTEXT_STATIMC_H
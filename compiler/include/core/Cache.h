@@ -0,0 +1,63 @@
+#ifndef STATIMC_CACHE_H
+#define STATIMC_CACHE_H
+
+/// Content-addressed cache of compiled packages.
+/// Copyright 2024 Nick Marino (github.com/nwmarino)
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ASTContext.h"
+
+/// BuildCache - An on-disk cache of the output of each package.
+///
+/// Entries live under `$XDG_CACHE_HOME/statimc`, or `~/.cache/statimc`, and are
+/// named by a hash of everything the output of a package depends on: its source,
+/// the compiler build, the flags, and the keys of the packages it imports, so a
+/// change to a package also misses for every package importing it. When every
+/// package of a crate hits, the compiler is skipped from lexing onwards. Entries
+/// are also kept in memory once read or written, so a compile server which
+/// answers hits itself reads each of them from disk once.
+class BuildCache final
+{
+private:
+  std::filesystem::path dir;
+  std::map<std::string, std::string> keys;
+
+public:
+  /// The default limit on the total size of all entries, in bytes.
+  static constexpr std::uintmax_t default_limit = 256ull << 20;
+
+  BuildCache();
+
+  /// Computes the keys of all packages in a crate from their sources and the given flags.
+  void add_packages(const std::vector<struct CFile> &files, const struct CFlags &flags);
+
+  /// Loads the cached output of a package into `unit`.
+  /// @returns `true` if the package has an entry.
+  bool load(const std::string &pkg, std::string &unit) const;
+
+  /// Stores the output of a package, and prunes the cache down to its size limit.
+  void store(const std::string &pkg, const std::string &unit) const;
+
+  /// Returns the directory entries are stored in.
+  inline const std::filesystem::path &get_dir() const { return dir; }
+
+  /// Returns the number of entries in the cache.
+  std::size_t count() const;
+
+  /// Returns the total size of all entries, in bytes.
+  std::uintmax_t size() const;
+
+  /// Returns the size limit from `$STATIMC_CACHE_LIMIT`, or the default limit if it is unset or not a size.
+  std::uintmax_t limit() const;
+
+  /// Removes the least recently used entries until the cache is no larger than the given size.
+  /// @returns The number of entries removed.
+  std::size_t prune(std::uintmax_t max_size) const;
+};
+
+#endif  // STATIMC_CACHE_H
@@ -0,0 +1,22 @@
+#ifndef STATIMC_LOADER_H
+#define STATIMC_LOADER_H
+
+/// Batched loading of source files.
+/// Copyright 2024 Nick Marino (github.com/nwmarino)
+
+#include <vector>
+
+#include "ASTContext.h"
+
+/// Reads the contents of every file which does not carry them yet.
+///
+/// Opens, sizes and reads are submitted for many files at once through io_uring,
+/// and each completion queues the next step of its file, so crates of many small
+/// files wait on the file system about as long as their slowest file rather than
+/// their total. Where io_uring is unavailable, like on older kernels or in
+/// sandboxes filtering it, or when `$STATIMC_NO_URING` is set, files are read with
+/// `pread` on a pool of threads instead. Files which could not be read are left
+/// without contents, so that reading them later reports the error.
+void load_sources(std::vector<struct CFile> &files);
+
+#endif  // STATIMC_LOADER_H
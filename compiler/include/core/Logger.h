@@ -9,11 +9,52 @@
 #include "../ast/Unit.h"
 #include "../token/Token.h"
 
+/// Diagnostic - A panic or warning reported while compiling.
+struct Diagnostic {
+  bool is_panic;
+  std::string msg;
+  struct Metadata meta;
+  bool has_meta;
+};
+
+
+/// CompileError - Thrown by a panic while diagnostics are being collected.
+struct CompileError {};
+
+
+/// Where panics and warnings on this thread are collected, instead of printed, when the compiler is embedded.
+/// Panics are thrown as a `CompileError` once collected, rather than exiting the process.
+inline thread_local std::vector<Diagnostic> *diag_sink = nullptr;
+
+
+/// Print a panic or warning to stderr.
+inline void print_diagnostic(const Diagnostic &diag) {
+  fprintf(stderr, "statimc: %s: %s\n", diag.is_panic ? "panic" : "warn", diag.msg.c_str());
+  if (diag.has_meta) {
+    fprintf(stderr, "see: %s:%u:%u\n", diag.meta.filename.c_str(), diag.meta.line_n, diag.meta.col_n);
+  }
+}
+
+
+/// Report a panic or warning, to the diagnostic sink of this thread if there is one, and to stderr otherwise.
+inline void report(bool is_panic, const std::string &msg, const struct Metadata *data) {
+  const Diagnostic diag = { is_panic, msg, data ? *data : Metadata(), data != nullptr };
+  if (diag_sink) {
+    diag_sink->push_back(diag);
+    return;
+  }
+  print_diagnostic(diag);
+}
+
+
 /// Stop the compiler and print an error message.
 /// @param m    The error message.
 [[noreturn]]
 inline void panic(const std::string msg) {
-  fprintf(stderr, "statimc: panic: %s\n", msg.c_str());
+  report(true, msg, nullptr);
+  if (diag_sink) {
+    throw CompileError();
+  }
   exit(1);
 }
 
@@ -23,7 +64,10 @@ inline void panic(const std::string msg) {
 /// @param data Metadata about the bad input.
 [[noreturn]]
 inline void panic(const std::string msg, const struct Metadata &data) {
-  fprintf(stderr, "statimc: panic: %s\nsee: %s:%zu:%zu\n", msg.c_str(), data.filename.c_str(), data.line_n, data.col_n);
+  report(true, msg, &data);
+  if (diag_sink) {
+    throw CompileError();
+  }
   exit(1);
 }
 
@@ -64,12 +108,20 @@ inline void enum_variant_panic(const std::string &ident, const std::string &enum
 }
 
 
+/// Warn about valid input which is likely to perform poorly, without stopping the compiler.
+/// @param msg  The warning message.
+/// @param data Metadata about the input.
+inline void warn(const std::string &msg, const struct Metadata &data) {
+  report(false, msg, &data);
+}
+
+
 /// Warn about a statement parsing error.
 /// @param msg  The error message.
 /// @param data Metadata about the bad input.
 /// @return     nullptr
 inline std::unique_ptr<Stmt> warn_stmt(std::string msg, const struct Metadata &data) {
-  fprintf(stderr, "statimc: warn: %s\nsee: %s:%zu:%zu\n", msg.c_str(), data.filename.c_str(), data.line_n, data.col_n);
+  warn(msg, data);
   return nullptr;
 }
 
@@ -79,7 +131,7 @@ inline std::unique_ptr<Stmt> warn_stmt(std::string msg, const struct Metadata &d
 /// @param data Metadata about the bad input.
 /// @return     nullptr
 inline std::unique_ptr<Expr> warn_expr(std::string msg, const struct Metadata &data) {
-  fprintf(stderr, "statimc: warn: %s\nsee: %s:%zu:%zu\n", msg.c_str(), data.filename.c_str(), data.line_n, data.col_n);
+  warn(msg, data);
   return nullptr;
 }
 
@@ -89,7 +141,7 @@ inline std::unique_ptr<Expr> warn_expr(std::string msg, const struct Metadata &d
 /// @param data Metadata about the bad input.
 /// @return     nullptr
 inline std::unique_ptr<Decl> warn_decl(std::string msg, const struct Metadata &data) {
-  fprintf(stderr, "statimc: warn: %s\nsee: %s:%zu:%zu\n", msg.c_str(), data.filename.c_str(), data.line_n, data.col_n);
+  warn(msg, data);
   return nullptr;
 }
 
@@ -99,7 +151,7 @@ inline std::unique_ptr<Decl> warn_decl(std::string msg, const struct Metadata &d
 /// @param data Metadata about the bad input.
 /// @return     nullptr
 inline std::unique_ptr<TypeDecl> warn_tydecl(std::string msg, const struct Metadata &data) {
-  fprintf(stderr, "statimc: warn: %s\nsee: %s:%zu:%zu\n", msg.c_str(), data.filename.c_str(), data.line_n, data.col_n);
+  warn(msg, data);
   return nullptr;
 }
 
@@ -109,7 +161,7 @@ inline std::unique_ptr<TypeDecl> warn_tydecl(std::string msg, const struct Metad
 /// @param data Metadata about the bad input.
 /// @return     nullptr
 inline std::unique_ptr<FunctionDecl> warn_fn(std::string msg, const struct Metadata &data) {
-  fprintf(stderr, "statimc: warn: %s\nsee: %s:%zu:%zu\n", msg.c_str(), data.filename.c_str(), data.line_n, data.col_n);
+  warn(msg, data);
   return nullptr;
 }
 
@@ -119,7 +171,7 @@ inline std::unique_ptr<FunctionDecl> warn_fn(std::string msg, const struct Metad
 /// @param data Metadata about the bad input.
 /// @return     nullptr
 inline std::unique_ptr<EnumDecl> warn_enum(std::string msg, const struct Metadata &data) {
-  fprintf(stderr, "statimc: warn: %s\nsee: %s:%zu:%zu\n", msg.c_str(), data.filename.c_str(), data.line_n, data.col_n);
+  warn(msg, data);
   return nullptr;
 }
 
@@ -129,7 +181,7 @@ inline std::unique_ptr<EnumDecl> warn_enum(std::string msg, const struct Metadat
 /// @param data Metadata about the bad input.
 /// @return     nullptr
 inline std::unique_ptr<StructDecl> warn_struct(std::string msg, const struct Metadata &data) {
-  fprintf(stderr, "statimc: warn: %s\nsee: %s:%zu:%zu\n", msg.c_str(), data.filename.c_str(), data.line_n, data.col_n);
+  warn(msg, data);
   return nullptr;
 }
 
@@ -139,7 +191,7 @@ inline std::unique_ptr<StructDecl> warn_struct(std::string msg, const struct Met
 /// @param data Metadata about the bad input.
 /// @return     nullptr
 inline std::unique_ptr<TraitDecl> warn_trait(std::string msg, const struct Metadata &data) {
-  fprintf(stderr, "statimc: warn: %s\nsee: %s:%zu:%zu\n", msg.c_str(), data.filename.c_str(), data.line_n, data.col_n);
+  warn(msg, data);
   return nullptr;
 }
 
@@ -149,7 +201,7 @@ inline std::unique_ptr<TraitDecl> warn_trait(std::string msg, const struct Metad
 /// @param data Metadata about the bad input.
 /// @return     nullptr
 inline std::unique_ptr<ImplDecl> warn_impl(std::string msg, const struct Metadata &data) {
-  fprintf(stderr, "statimc: warn: %s\nsee: %s:%zu:%zu\n", msg.c_str(), data.filename.c_str(), data.line_n, data.col_n);
+  warn(msg, data);
   return nullptr;
 }
 
@@ -159,7 +211,7 @@ inline std::unique_ptr<ImplDecl> warn_impl(std::string msg, const struct Metadat
 /// @param data Metadata about the bad input.
 /// @return     nullptr
 inline std::unique_ptr<Unit> warn_unit(std::string msg, const struct Metadata &data) {
-  fprintf(stderr, "statimc: warn: %s\nsee: %s:%zu:%zu\n", msg.c_str(), data.filename.c_str(), data.line_n, data.col_n);
+  warn(msg, data);
   return nullptr;
 }
 
@@ -169,7 +221,7 @@ inline std::unique_ptr<Unit> warn_unit(std::string msg, const struct Metadata &d
 /// @param data Metadata about the bad input.
 /// @return     nullptr
 inline std::unique_ptr<PackageUnit> warn_pkg(std::string msg, const struct Metadata &data) {
-  fprintf(stderr, "statimc: warn: %s\nsee: %s:%zu:%zu\n", msg.c_str(), data.filename.c_str(), data.line_n, data.col_n);
+  warn(msg, data);
   return nullptr;
 }
 
@@ -0,0 +1,25 @@
+#ifndef STATIMC_LSP_H
+#define STATIMC_LSP_H
+
+/// Language server of the compiler.
+/// Copyright 2024 Nick Marino (github.com/nwmarino)
+
+#include <filesystem>
+#include <vector>
+
+#include "ASTContext.h"
+
+/// Speaks the language server protocol over standard input and output, until the editor exits.
+///
+/// Open documents are analyzed on a background thread whenever they change, by
+/// parsing and checking the crate they belong to, with unsaved documents taking
+/// the place of their files. Each analysis runs in a forked child, so a panic only
+/// ends that analysis, and a newer edit cancels it by killing the child. The child
+/// reports panics and warnings, which are published as diagnostics, and a table of
+/// every declaration with its type and location, from which hovers, definitions
+/// and completions of struct fields and methods are answered without waiting.
+/// @param find_files Returns the source files of the crate in a directory.
+[[noreturn]]
+void run_lsp(std::vector<struct CFile> (*find_files)(const std::filesystem::path &));
+
+#endif  // STATIMC_LSP_H
@@ -0,0 +1,43 @@
+#ifndef STATIMC_MANIFEST_H
+#define STATIMC_MANIFEST_H
+
+/// Crate manifests and source discovery.
+/// Copyright 2024 Nick Marino (github.com/nwmarino)
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "ASTContext.h"
+
+/// Manifest - The manifest of a crate, read from `statim.toml` in its directory.
+///
+/// The manifest names the package holding `main` and the directories packages
+/// are searched for in, relative to the manifest:
+/// ```
+/// entry = "main"
+/// roots = ["src", "../lib"]
+/// ```
+/// Both keys are optional, and default to `main` and the directory of the manifest.
+struct Manifest {
+  std::string entry;
+  std::vector<std::filesystem::path> roots;
+};
+
+
+/// Reads the manifest of the crate in a directory. Panics if the manifest is malformed.
+/// @returns `true` if the directory has a manifest.
+bool load_manifest(const std::filesystem::path &dir, Manifest &manifest);
+
+/// Finds the sources of the entry package of a manifest and every package it imports, transitively.
+///
+/// Package `a` is the file `a.statim`, and package `a::b` the file `a/b.statim`,
+/// in the first root holding it. Files are named by their path from the root, so
+/// the package of `a/b.statim` is `a/b`, which is how it is imported. Files are found, read and scanned for imports a
+/// level of the import tree at a time, with each level searched for on threads and
+/// loaded in one batch, and keep their contents so they are not read again. Imports
+/// which are not found are left for sema to report.
+/// @returns The files of the crate, with the entry package last so it is parsed first.
+std::vector<struct CFile> discover_files(const Manifest &manifest);
+
+#endif  // STATIMC_MANIFEST_H
@@ -0,0 +1,57 @@
+#ifndef STATIMC_SERVER_H
+#define STATIMC_SERVER_H
+
+/// Compile server and its client.
+/// Copyright 2024 Nick Marino (github.com/nwmarino)
+
+#include <string>
+#include <vector>
+
+/// ServerRequest - A compile forwarded to the compile server by a client.
+///
+/// The client passes its own standard output and error along with the request,
+/// so whatever serves it writes straight to the terminal or pipe of the client.
+struct ServerRequest {
+  /// The working directory of the client.
+  std::string cwd;
+
+  /// The command line of the client, including the program name.
+  std::vector<std::string> args;
+
+  /// The standard output of the client.
+  int out;
+
+  /// The standard error of the client.
+  int err;
+};
+
+
+/// Returns the path of the compile server socket.
+///
+/// This is `$STATIMC_SERVER` if it is set, or else `statimc.sock` in `$XDG_RUNTIME_DIR`
+/// or a per-user path in `/tmp`.
+[[nodiscard]]
+std::string get_server_path(void);
+
+
+/// Listens for compile requests on a Unix domain socket, until the server is killed.
+///
+/// Each request is first passed to `serve` in the server itself, which may keep
+/// what it reads in memory for later requests, and must not exit. If it returns
+/// -1, the request is compiled by `compile` in a forked copy of the server
+/// instead, so that the server never sees the state of a compile and survives
+/// its panics. What the copy learns is lost with it.
+/// @param path    The path to bind the socket to.
+/// @param serve   Serves a request in the server, and returns its exit status or -1.
+/// @param compile Compiles a request from its command line, in its working directory.
+[[noreturn]]
+void run_server(const std::string &path, int (*serve)(const ServerRequest &), int (*compile)(int, char **));
+
+
+/// Forwards this invocation of the compiler to the compile server.
+/// @param path   The path of the server socket.
+/// @param status The exit status of the compile, if it was forwarded.
+/// @returns      `false` if no server is listening.
+bool run_client(const std::string &path, int argc, char *argv[], int &status);
+
+#endif  // STATIMC_SERVER_H
@@ -20,6 +20,7 @@ public:
   virtual bool is_builtin(void) const = 0;
   virtual bool is_matchable(void) const = 0;
   virtual bool is_char(void) const = 0;
+  virtual bool is_str(void) const = 0;
   virtual bool is_ref(void) const = 0;
   virtual std::string to_string(void) const = 0;
 };
@@ -50,11 +51,31 @@ public:
   bool is_builtin(void) const override { return false; }
   bool is_matchable(void) const override { return false; }
   bool is_char(void) const override { return false; }
+  bool is_str(void) const override { return false; }
   bool is_ref(void) const override { return true; }
   std::string to_string(void) const override { return ident + " ref"; }
 };
 
 
+/// StrLayout - The runtime representation of the builtin `str` type.
+///
+/// A `str` is a 16-byte value made of a data pointer and a length. Strings of
+/// up to 15 bytes are stored inline in the value itself, with the last byte
+/// holding the inline length, so short strings never allocate. Longer strings
+/// point into the interned literal pool or the heap.
+struct StrLayout final
+{
+  /// The size of a `str` value in bytes.
+  static constexpr unsigned int size = 16;
+
+  /// The maximum number of bytes stored inline in a `str` value.
+  static constexpr unsigned int inline_cap = 15;
+
+  /// Returns true if a string of the given length is stored inline.
+  static constexpr bool is_inline(std::size_t len) { return len <= inline_cap; }
+};
+
+
 /// PrimitiveType - A primitive type in the language.
 ///
 /// This class represents a primitive type in the intermediate representation.
@@ -64,14 +85,20 @@ class PrimitiveType final : public Type
 public:
   enum PrimitiveKind {
     __UINT1,
+    __INT8,
+    __UINT8,
+    __INT16,
+    __UINT16,
     __UINT32,
     __INT32,
+    __UINT64,
     __INT64,
     __FP32,
     __FP64,
     __CHAR,
+    __STR,
   };
-  bool is_bool_evaluable(void) const override { return true; }
+  bool is_bool_evaluable(void) const override { return !is_str(); }
   bool is_null(void) const override { return false; }
   bool is_void(void) const override { return false; }
   bool is_builtin(void) const override { return true; }
@@ -100,21 +127,110 @@ public:
   bool is_integer(void) const override { return get_kind() <= __INT64; }
   bool is_float(void) const override { return get_kind() == __FP32 || get_kind() == __FP64; }
   bool is_char(void) const override { return get_kind() == __CHAR; }
+  bool is_str(void) const override { return get_kind() == __STR; }
+
+  /// Returns true if this is a signed integer type.
+  bool is_signed(void) const {
+    return get_kind() == __INT8 || get_kind() == __INT16 || get_kind() == __INT32 || get_kind() == __INT64;
+  }
+
+  /// Returns the width of this type in bits.
+  unsigned int get_bits(void) const {
+    switch (get_kind()) {
+      case __UINT1: return 1;
+      case __INT8: case __UINT8: case __CHAR: return 8;
+      case __INT16: case __UINT16: return 16;
+      case __UINT32: case __INT32: case __FP32: return 32;
+      case __UINT64: case __INT64: case __FP64: return 64;
+      case __STR: return StrLayout::size * 8;
+      default: return 0;
+    }
+  }
+
   std::string to_string(void) const override {
     switch (get_kind()) {
       case __UINT1: return "bool";
+      case __INT8: return "i8";
+      case __UINT8: return "u8";
+      case __INT16: return "i16";
+      case __UINT16: return "u16";
       case __UINT32: return "u32";
       case __INT32: return "i32";
+      case __UINT64: return "u64";
       case __INT64: return "i64";
       case __FP32: return "f32";
       case __FP64: return "f64";
       case __CHAR: return "char";
+      case __STR: return "str";
       default: return "unknown";
     }
   }
 };
 
 
+/// VectorType - A fixed-width SIMD vector type in the language.
+///
+/// Vectors hold a fixed number of lanes of a primitive type, for example `f32x4`
+/// or `u8x16`, and operate on all of their lanes at once. Comparing two vectors
+/// produces a mask, a vector of the same shape with each lane either all ones
+/// or all zeros. Vectors of 128 bits map onto SSE registers and vectors of 256
+/// bits onto AVX registers, and are lowered to scalar loops on targets without them.
+class VectorType final : public Type
+{
+private:
+  const PrimitiveType *__elem;
+  const unsigned int __lanes;
+  const unsigned int __lane_bits;
+  const VectorType *__mask;
+
+public:
+  /// @param elem The type of each lane.
+  /// @param lanes The number of lanes.
+  /// @param mask The mask type produced by comparing vectors of this type.
+  VectorType(const PrimitiveType *elem, unsigned int lanes, const VectorType *mask)
+    : __elem(elem), __lanes(lanes), __lane_bits(elem->get_bits()), __mask(mask){};
+
+  /// Creates a mask type, shared by all vector types with the same lane width and count.
+  /// @param lane_bits The width of each lane in bits.
+  /// @param lanes The number of lanes.
+  VectorType(unsigned int lane_bits, unsigned int lanes)
+    : __elem(nullptr), __lanes(lanes), __lane_bits(lane_bits), __mask(nullptr){};
+  bool is_bool_evaluable(void) const override { return false; }
+  bool is_null(void) const override { return false; }
+  bool is_void(void) const override { return false; }
+  bool is_bool(void) const override { return false; }
+  bool is_integer(void) const override { return false; }
+  bool is_float(void) const override { return false; }
+  bool is_builtin(void) const override { return true; }
+  bool is_matchable(void) const override { return false; }
+  bool is_char(void) const override { return false; }
+  bool is_str(void) const override { return false; }
+  bool is_ref(void) const override { return false; }
+
+  /// Gets the type of each lane, or `nullptr` if this is a mask.
+  const PrimitiveType *get_elem(void) const { return __elem; }
+
+  /// Gets the number of lanes.
+  unsigned int get_lanes(void) const { return __lanes; }
+
+  /// Returns the width of this vector in bits.
+  unsigned int get_bits(void) const { return __lane_bits * __lanes; }
+
+  /// Returns true if this is a mask type.
+  bool is_mask(void) const { return __elem == nullptr; }
+
+  /// Gets the mask type produced by comparing vectors of this type, or `nullptr` if this is a mask.
+  const VectorType *get_mask_type(void) const { return __mask; }
+
+  std::string to_string(void) const override {
+    if (is_mask()) {
+      return "m" + std::to_string(__lane_bits) + "x" + std::to_string(__lanes);
+    }
+    return __elem->to_string() + "x" + std::to_string(__lanes);
+  }
+};
+
+
 /// DefinedType - Represents a type defined by the source.
 class DefinedType : public Type
 {
@@ -129,6 +245,7 @@ public:
   bool is_builtin(void) const override { return false; }
   bool is_matchable(void) const override { return false; }
   bool is_char(void) const override { return false; }
+  bool is_str(void) const override { return false; }
   bool is_ref(void) const override { return false; }
   virtual bool is_enum(void) const = 0;
   virtual bool is_struct(void) const = 0;
@@ -138,7 +255,7 @@ public:
 /// ArrayType - Represents an array type.
 ///
 /// This class represents an array type in the intermediate representation.
-/// All defined array types are represented by this class.
+/// All defined array types are represented by this class, for example `[i32; 4]`.
 class ArrayType final : public DefinedType 
 {
 private:
@@ -150,7 +267,9 @@ public:
   ArrayType(unsigned int size, const Type *T) : __len(size), __type(T){};
   bool is_builtin(void) const override { return false; }
   bool is_valid_element(void) const;
-  std::string to_string(void) const override { return __type->to_string() + "[" + std::to_string(__len) + "]"; }
+  const Type *get_type(void) const { return __type; }
+  unsigned int get_len(void) const { return __len; }
+  std::string to_string(void) const override { return "[" + __type->to_string() + "; " + std::to_string(__len) + "]"; }
   
   // later, need to implement is_enum and is_struct in terms of element
   bool is_enum(void) const override { return false; }
@@ -158,6 +277,60 @@ public:
 };
 
 
+/// SliceType - Represents a slice type.
+///
+/// A slice is a view over a contiguous run of elements owned by an array,
+/// a heap buffer or a `str`, for example `[u8]`. Slicing never copies.
+class SliceType final : public DefinedType
+{
+private:
+  const Type *__type;
+
+public:
+  /// @param T The element type of the slice.
+  SliceType(const Type *T) : __type(T){};
+  bool is_builtin(void) const override { return false; }
+  const Type *get_type(void) const { return __type; }
+  std::string to_string(void) const override { return "[" + __type->to_string() + "]"; }
+  bool is_enum(void) const override { return false; }
+  bool is_struct(void) const override { return false; }
+};
+
+
+/// SliceLayout - The runtime representation of slice types.
+///
+/// A slice is a 16-byte value made of a data pointer and an element count.
+/// Under the calling convention it is passed and returned in two registers,
+/// never through memory.
+struct SliceLayout final
+{
+  /// The size of a slice value in bytes.
+  static constexpr unsigned int size = 16;
+
+  /// The number of registers a slice value is passed in.
+  static constexpr unsigned int regs = 2;
+};
+
+
+/// SliceAlgorithms - Tuning of the builtin parallel algorithms on arrays, slices and vectors.
+///
+/// Sorting is a parallel samplesort whose buckets are sorted by pdqsort, and
+/// scans, reductions, filters and partitions split their input into blocks which
+/// are processed by worker threads and then combined. Inputs shorter than the
+/// cutoff are processed sequentially on the calling thread.
+struct SliceAlgorithms final
+{
+  /// The number of elements below which an algorithm runs sequentially.
+  static constexpr unsigned int seq_cutoff = 1 << 14;
+
+  /// The number of elements in each block processed by a worker thread.
+  static constexpr unsigned int block_size = 1 << 12;
+
+  /// The number of samples taken per bucket when choosing samplesort splitters.
+  static constexpr unsigned int oversampling = 16;
+};
+
+
 /// RuneType - Represents a rune type.
 ///
 /// This class represents a rune type in the intermediate representation.
@@ -171,6 +344,7 @@ public:
   /// @param T The type which the rune points to.
   RuneType(const Type *T) : __type(T){};
   bool is_builtin(void) const override { return false; }
+  const Type *get_type(void) const { return __type; }
   bool is_valid_element(void) const;
   std::string to_string(void) const override { return '#' + __type->to_string(); }
 
@@ -180,6 +354,231 @@ public:
 };
 
 
+/// TaskType - Represents a handle to a spawned task.
+///
+/// This class represents the join handle returned by a `spawn` expression.
+/// Joining the handle waits for the task and yields its result.
+class TaskType final : public DefinedType
+{
+private:
+  const Type *__type;
+
+public:
+  /// @param T The result type of the task, or `nullptr` if it returns nothing.
+  TaskType(const Type *T) : __type(T){};
+  bool is_builtin(void) const override { return false; }
+  const Type *get_type(void) const { return __type; }
+  std::string to_string(void) const override { return "task<" + (__type ? __type->to_string() : "void") + ">"; }
+  bool is_enum(void) const override { return false; }
+  bool is_struct(void) const override { return false; }
+};
+
+
+/// AtomicType - Represents an atomic cell.
+///
+/// This class represents an `atomic<T>` over an integer, bool or rune. Atomics are only accessed through
+/// their builtin methods, each of which names its memory ordering. On x86-64, loads and release stores are
+/// plain moves, sequentially consistent stores and swaps use `xchg`, `compare_exchange` uses `lock cmpxchg`
+/// and `fetch_add` uses `lock xadd`.
+class AtomicType final : public DefinedType
+{
+private:
+  const Type *__type;
+
+public:
+  /// @param T The type of the value held by the atomic.
+  AtomicType(const Type *T) : __type(T){};
+  bool is_builtin(void) const override { return false; }
+  const Type *get_type(void) const { return __type; }
+  std::string to_string(void) const override { return "atomic<" + __type->to_string() + ">"; }
+  bool is_enum(void) const override { return false; }
+  bool is_struct(void) const override { return false; }
+};
+
+
+/// ChanLayout - The runtime representation of channel types.
+///
+/// A channel value is a handle to a bounded multi-producer/multi-consumer ring
+/// buffer, so copies of it share the same ring. Each slot holds a sequence number
+/// next to its value, and producers and consumers claim slots by a compare and swap
+/// on their own cursor, which live on separate cache lines. Blocked operations spin
+/// before parking their thread.
+struct ChanLayout final
+{
+  /// The size of a channel handle in bytes.
+  static constexpr unsigned int size = 8;
+
+  /// The size of the cache lines the producer and consumer cursors are padded to.
+  static constexpr unsigned int cache_line = 64;
+
+  /// The size of the sequence number heading each slot, in bytes.
+  static constexpr unsigned int seq_size = 8;
+
+  /// The number of failed attempts a blocked operation spins for before parking.
+  static constexpr unsigned int spin_limit = 128;
+};
+
+
+/// ChanType - Represents a channel type.
+///
+/// This class represents a `chan<T; N>`, a bounded channel of values of type `T`
+/// with a capacity of `N` slots. Capacities are powers of two, so slot indices are
+/// masked rather than divided.
+class ChanType final : public DefinedType
+{
+private:
+  const unsigned int __cap;
+  const Type *__type;
+
+public:
+  /// @param cap The number of slots in the channel.
+  /// @param T The type of the values sent on the channel.
+  ChanType(unsigned int cap, const Type *T) : __cap(cap), __type(T){};
+  bool is_builtin(void) const override { return false; }
+  const Type *get_type(void) const { return __type; }
+  unsigned int get_cap(void) const { return __cap; }
+  std::string to_string(void) const override { return "chan<" + __type->to_string() + "; " + std::to_string(__cap) + ">"; }
+  bool is_enum(void) const override { return false; }
+  bool is_struct(void) const override { return false; }
+};
+
+
+/// VecLayout - The runtime representation of `Vec` types.
+///
+/// A `Vec` is a 24-byte value made of a heap data pointer, a length and a
+/// capacity. Pushing into a full buffer reallocates it with a larger capacity,
+/// so pushes are amortized constant time.
+struct VecLayout final
+{
+  /// The size of a `Vec` value in bytes.
+  static constexpr unsigned int size = 24;
+
+  /// The capacity of the first allocation, in elements.
+  static constexpr unsigned int min_cap = 4;
+
+  /// The factor the capacity grows by when the buffer is full.
+  static constexpr unsigned int growth = 2;
+};
+
+
+/// MapLayout - The runtime representation of `Map` types.
+///
+/// A `Map` is an open-addressing table of slots, with one control byte per
+/// slot kept apart from the slots. A control byte holds 7 bits of the hash of
+/// the key in its slot, or marks the slot as empty or deleted. Lookups compare
+/// a whole group of control bytes against the hash at once, and only probe the
+/// slots that match.
+struct MapLayout final
+{
+  /// The size of a `Map` value in bytes.
+  static constexpr unsigned int size = 32;
+
+  /// The number of control bytes probed at once, one SSE2 register.
+  static constexpr unsigned int group_width = 16;
+
+  /// The maximum load of the table, in eighths, before it grows.
+  static constexpr unsigned int max_load = 7;
+};
+
+
+/// VecType - Represents a growable vector type.
+///
+/// This class represents a `Vec<T>`, a heap buffer of values of type `T` which grows as values are pushed.
+class VecType final : public DefinedType
+{
+private:
+  const Type *__type;
+
+public:
+  /// @param T The type of the elements of the vector.
+  VecType(const Type *T) : __type(T){};
+  bool is_builtin(void) const override { return false; }
+  const Type *get_type(void) const { return __type; }
+  std::string to_string(void) const override { return "Vec<" + __type->to_string() + ">"; }
+  bool is_enum(void) const override { return false; }
+  bool is_struct(void) const override { return false; }
+};
+
+
+/// MapType - Represents a hash map type.
+///
+/// This class represents a `Map<K, V>`, a hash table from keys of type `K` to values of type `V`.
+class MapType final : public DefinedType
+{
+private:
+  const Type *__key;
+  const Type *__value;
+
+public:
+  /// @param K The type of the keys of the map.
+  /// @param V The type of the values of the map.
+  MapType(const Type *K, const Type *V) : __key(K), __value(V){};
+  bool is_builtin(void) const override { return false; }
+  const Type *get_key_type(void) const { return __key; }
+  const Type *get_value_type(void) const { return __value; }
+  std::string to_string(void) const override {
+    return "Map<" + __key->to_string() + ", " + __value->to_string() + ">";
+  }
+  bool is_enum(void) const override { return false; }
+  bool is_struct(void) const override { return false; }
+};
+
+
+/// MappedFileLayout - The runtime representation of the builtin `MappedFile` type.
+///
+/// A `MappedFile` is a 24-byte value made of a data pointer, a length and a
+/// descriptor. Regular files are mapped read-only, so reading them takes no
+/// copies and no system calls past the first fault of each page. Pipes and
+/// other unmappable inputs are read into a heap buffer in large reads instead,
+/// and expose the same bytes. A file which failed to open is empty, and keeps
+/// the negated `errno` in place of its descriptor.
+struct MappedFileLayout final
+{
+  /// The size of a `MappedFile` value in bytes.
+  static constexpr unsigned int size = 24;
+
+  /// The size of each read when falling back from mapping, in bytes.
+  static constexpr unsigned int read_size = 1 << 20;
+};
+
+
+/// MappedFileType - Represents a read-only view of a file.
+///
+/// This class represents the builtin `MappedFile` type returned by `map_file`, whose contents are exposed as a
+/// `[u8]` slice.
+class MappedFileType final : public DefinedType
+{
+public:
+  MappedFileType(){};
+  bool is_builtin(void) const override { return false; }
+  std::string to_string(void) const override { return "MappedFile"; }
+  bool is_enum(void) const override { return false; }
+  bool is_struct(void) const override { return false; }
+};
+
+
+/// StructLayout - Describes how struct fields are laid out in memory.
+///
+/// Fields are placed in declaration order, each at the next offset which is a
+/// multiple of its alignment, and the size of a struct is rounded up to its own
+/// alignment. A `#[align(N)]` attribute raises the alignment of a struct or a field.
+/// A `#[cache_padded]` field starts a cache line and is padded to the end of it,
+/// so no other field shares its line.
+struct StructLayout final
+{
+  /// The size of the cache lines `#[cache_padded]` fields are placed on, in bytes.
+  static constexpr unsigned int cache_line = 64;
+
+  /// The largest alignment an `#[align(N)]` attribute may request, in bytes.
+  static constexpr unsigned int max_align = 4096;
+
+  /// Returns the given offset rounded up to a multiple of the given power of two alignment.
+  static constexpr unsigned long align_to(unsigned long offset, unsigned int align) {
+    return (offset + align - 1) & ~static_cast<unsigned long>(align - 1);
+  }
+};
+
+
 /// StructType - Represents a struct type.
 ///
 /// This class represents a struct type in the intermediate representation.
@@ -4,24 +4,26 @@
 /// Utility functions for the compiler.
 /// Copyright 2024 Nick Marino (github.com/nwmarino)
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <string>
+#include <vector>
 
 /// Read the contents of a file to a string.
 [[nodiscard]]
 inline std::string read_to_str(const std::string &path) {
-  std::ifstream file(path);
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
 
   if (!file.is_open()) {
     fprintf(stderr, "could not open file: %s\n", path.c_str());
+    return "";
   }
 
-  std::string contents;
-  std::string line;
-  while (getline(file, line)) {
-    contents.append(line + '\n');
-  }
-
+  // read the file in a single pass, rather than line by line
+  std::string contents(file.tellg(), '\0');
+  file.seekg(0);
+  file.read(contents.data(), contents.size());
   return contents;
 }
 
@@ -42,6 +44,34 @@ inline std::string remove_extension(const std::string &filename) {
 }
 
 
+/// Returns the packages imported by a source file, without lexing it.
+///
+/// Imports are whole lines in the form `pkg <identifier>;` or `pkg <identifier>::<identifier>;`,
+/// and paths are returned with `/` separators.
+[[nodiscard]]
+inline std::vector<std::string> scan_imports(const std::string &src) {
+  std::vector<std::string> imports;
+  std::size_t pos = 0;
+  while (pos < src.size()) {
+    std::size_t end = src.find('\n', pos);
+    end = end == std::string::npos ? src.size() : end;
+
+    const std::size_t start = src.find_first_not_of(" \t", pos);
+    if (start < end && src.compare(start, 4, "pkg ") == 0) {
+      const std::size_t semi = src.find(';', start);
+      if (semi < end) {
+        std::string name = src.substr(start + 4, semi - start - 4);
+        name.erase(std::remove_if(name.begin(), name.end(), ::isspace), name.end());
+        const std::size_t path = name.find("::");
+        imports.push_back(path == std::string::npos ? name : name.replace(path, 2, "/"));
+      }
+    }
+    pos = end + 1;
+  }
+  return imports;
+}
+
+
 /// Read in the current working directory.
 [[nodiscard]]
 inline std::string read_cwd(void) {
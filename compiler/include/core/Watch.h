@@ -0,0 +1,21 @@
+#ifndef STATIMC_WATCH_H
+#define STATIMC_WATCH_H
+
+/// File-watch mode of the compiler.
+/// Copyright 2024 Nick Marino (github.com/nwmarino)
+
+#include <string>
+
+/// Compiles the crate in the current directory, and again whenever one of its sources changes, until killed.
+///
+/// The source tree is followed with inotify, including directories created
+/// later, along with the search roots of the manifest of the crate, which are
+/// watched again whenever the manifest changes. Bursts of events, like an editor saving several files, are coalesced
+/// into one rebuild once the tree has been quiet for a moment. Each rebuild runs
+/// in a forked child, so a panic in it does not stop the watch, and its time is
+/// printed when it finishes.
+/// @param compile Compiles the crate in the current directory from a command line.
+[[noreturn]]
+void run_watch(int (*compile)(int, char **), int argc, char *argv[]);
+
+#endif  // STATIMC_WATCH_H
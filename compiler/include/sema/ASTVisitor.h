@@ -4,6 +4,10 @@
 /// Visitor pattern for AST passes.
 /// Copyright 2024 Nick Marino (github.com/nwmarino)
 
+#include <memory>
+
+struct SemaState;
+
 class Decl;
 class Expr;
 class Unit;
@@ -28,6 +32,7 @@ class IfStmt;
 class MatchCase;
 class MatchStmt;
 class UntilStmt;
+class ForStmt;
 class ReturnStmt;
 class BreakStmt;
 class ContinueStmt;
@@ -47,6 +52,15 @@ class CallExpr;
 class MemberExpr;
 class MemberCallExpr;
 class ThisExpr;
+class AwaitExpr;
+class SpawnExpr;
+class VectorExpr;
+class CastExpr;
+class ArrayExpr;
+class MapExpr;
+class IndexExpr;
+class SliceExpr;
+class PrintExpr;
 
 /// ASTVisitor - Base class to all ASt visitors.
 ///
@@ -77,6 +91,7 @@ public:
   virtual void visit(MatchCase *s) = 0;
   virtual void visit(MatchStmt *s) = 0;
   virtual void visit(UntilStmt *s) = 0;
+  virtual void visit(ForStmt *s) = 0;
   virtual void visit(ReturnStmt *s) = 0;
   virtual void visit(BreakStmt *s) = 0;
   virtual void visit(ContinueStmt *s) = 0;
@@ -96,6 +111,15 @@ public:
   virtual void visit(MemberExpr *e) = 0;
   virtual void visit(MemberCallExpr *e) = 0;
   virtual void visit(ThisExpr *e) = 0;
+  virtual void visit(AwaitExpr *e) = 0;
+  virtual void visit(SpawnExpr *e) = 0;
+  virtual void visit(VectorExpr *e) = 0;
+  virtual void visit(CastExpr *e) = 0;
+  virtual void visit(ArrayExpr *e) = 0;
+  virtual void visit(MapExpr *e) = 0;
+  virtual void visit(IndexExpr *e) = 0;
+  virtual void visit(SliceExpr *e) = 0;
+  virtual void visit(PrintExpr *e) = 0;
 };
 
 
@@ -106,7 +130,13 @@ public:
 /// as well as final name resolution and type checking.
 class PassVisitor final : public ASTVisitor
 {
+  /// The bookkeeping of the crate this visitor checks, kept for linking it.
+  std::unique_ptr<SemaState> state;
+
 public:
+  PassVisitor();
+  ~PassVisitor();
+
   void visit(CrateUnit *u) override;
   void visit(PackageUnit *u) override;
 
@@ -126,6 +156,7 @@ public:
   void visit(MatchCase *s) override;
   void visit(MatchStmt *s) override;
   void visit(UntilStmt *s) override;
+  void visit(ForStmt *s) override;
   void visit(ReturnStmt *s) override;
   void visit(BreakStmt *s) override;
   void visit(ContinueStmt *s) override;
@@ -145,6 +176,22 @@ public:
   void visit(MemberExpr *e) override;
   void visit(MemberCallExpr *e) override;
   void visit(ThisExpr *e) override;
+  void visit(AwaitExpr *e) override;
+  void visit(SpawnExpr *e) override;
+  void visit(VectorExpr *e) override;
+  void visit(CastExpr *e) override;
+  void visit(ArrayExpr *e) override;
+  void visit(MapExpr *e) override;
+  void visit(IndexExpr *e) override;
+  void visit(SliceExpr *e) override;
+  void visit(PrintExpr *e) override;
+
+  /// Optimizes a checked crate as a whole, across its packages.
+  ///
+  /// Functions and methods which are unreachable from the entry function are
+  /// removed, except for the methods of trait implementations, and functions
+  /// with a single call site in the crate are marked to be inlined into it.
+  void link(CrateUnit *u);
 };
 
 #endif  // ASTVISITOR_STATIMC_H
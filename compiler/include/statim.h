@@ -0,0 +1,108 @@
+#ifndef STATIM_H
+#define STATIM_H
+
+/// C interface to the compiler, built as `libstatim`.
+/// Copyright 2024 Nick Marino (github.com/nwmarino)
+///
+/// A session compiles one crate from sources added in memory, without touching
+/// the file system or stopping the process. Panics and warnings are collected in
+/// the session rather than printed, and a panic only fails the session it was
+/// raised in. Sessions share no state, so any number of them may be used at once,
+/// each from one thread at a time.
+
+#include <stddef.h>
+
+#if defined(_WIN32)
+#define STATIM_API __declspec(dllexport)
+#else
+#define STATIM_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The version of this interface, which is raised only by changes that break existing callers.
+#define STATIM_API_VERSION 1
+
+/// statim_session - A compile of one crate.
+typedef struct statim_session statim_session;
+
+/// statim_phase - The phases of a compile, each of which runs the phases before it first.
+typedef enum statim_phase {
+  STATIM_PHASE_PARSE = 1,  // tokenize and parse every source into packages
+  STATIM_PHASE_CHECK = 2,  // resolve and type check the crate
+  STATIM_PHASE_LINK = 3,   // optimize across packages, if the session has `-flto`
+  STATIM_PHASE_EMIT = 4,   // print the output of each package
+} statim_phase;
+
+/// statim_status - The result of a call on a session.
+typedef enum statim_status {
+  STATIM_OK = 0,
+  STATIM_ERROR = 1,   // the compile panicked, see the diagnostics of the session
+  STATIM_MISUSE = 2,  // the call does not fit the state of the session, like adding a source after parsing
+} statim_status;
+
+/// statim_severity - The severity of a diagnostic.
+typedef enum statim_severity {
+  STATIM_SEVERITY_NONE = 0,   // the session or index does not name a diagnostic
+  STATIM_SEVERITY_PANIC = 1,
+  STATIM_SEVERITY_WARN = 2,
+} statim_severity;
+
+/// Returns the version of the interface the library was built with.
+STATIM_API unsigned int statim_api_version(void);
+
+/// Creates an empty session.
+/// @returns The session, or `NULL` if it could not be allocated.
+STATIM_API statim_session *statim_session_create(void);
+
+/// Destroys a session, and every string it returned.
+STATIM_API void statim_session_destroy(statim_session *session);
+
+/// Sets a command line flag of the compiler on a session, like `-flto`. Flags must be set before parsing.
+STATIM_API statim_status statim_session_set_flag(statim_session *session, const char *flag);
+
+/// Adds a source file to a session. Sources must be added before parsing.
+/// @param filename The name of the file, which names its package and appears in diagnostics.
+/// @param src      The contents of the file, which are copied.
+/// @param len      The length of the contents in bytes.
+STATIM_API statim_status statim_session_add_source(statim_session *session, const char *filename, const char *src,
+                                                   size_t len);
+
+/// Runs a session up to and including a phase. Phases which already ran are not run again.
+/// @returns `STATIM_ERROR` if the compile panicked in this or an earlier call.
+STATIM_API statim_status statim_session_run(statim_session *session, statim_phase phase);
+
+/// Returns the number of panics and warnings a session reported.
+STATIM_API size_t statim_diagnostic_count(const statim_session *session);
+
+/// Returns the severity of a diagnostic, or `STATIM_SEVERITY_NONE` if the session is `NULL` or the index is out of range.
+STATIM_API statim_severity statim_diagnostic_severity(const statim_session *session, size_t index);
+
+/// Returns the message of a diagnostic, or `NULL` if the session is `NULL` or the index is out of range.
+STATIM_API const char *statim_diagnostic_message(const statim_session *session, size_t index);
+
+/// Returns the file a diagnostic points to, or `NULL` if it has no location or does not exist.
+STATIM_API const char *statim_diagnostic_file(const statim_session *session, size_t index);
+
+/// Returns the 1-based line a diagnostic points to, or 0 if it has no location or does not exist.
+STATIM_API unsigned int statim_diagnostic_line(const statim_session *session, size_t index);
+
+/// Returns the 1-based column a diagnostic points to, or 0 if it has no location or does not exist.
+STATIM_API unsigned int statim_diagnostic_col(const statim_session *session, size_t index);
+
+/// Returns the number of outputs of a session, one per package once it is emitted.
+STATIM_API size_t statim_output_count(const statim_session *session);
+
+/// Returns the name of the package an output belongs to, or `NULL` if the output does not exist.
+STATIM_API const char *statim_output_name(const statim_session *session, size_t index);
+
+/// Returns the contents of an output, as `statimc` prints them, or `NULL` if the output does not exist.
+STATIM_API const char *statim_output(const statim_session *session, size_t index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // STATIM_H
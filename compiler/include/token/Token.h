@@ -7,32 +7,46 @@
 #include <string>
 
 static const std::string RESERVED[] = {
+  "as",
+  "async",
+  "await",
   "bool",
   "break",
   "char",
   "continue",
   "else",
   "enum",
+  "f32",
+  "f64",
   "false",
   "float",
   "fn",
   "for",
+  "i8",
+  "i16",
   "i32",
   "i64",
   "if",
   "impl",
+  "in",
   "let",
   "match",
   "mut",
   "null",
+  "par",
   "pkg",
   "priv",
   "return",
+  "spawn",
   "str",
   "struct",
   "this",
   "trait",
   "true",
+  "u8",
+  "u16",
+  "u32",
+  "u64",
   "uint",
   "until",
   "void",
@@ -116,6 +130,8 @@ typedef enum {
   ///
   /// "::"
   Path,
+  /// ".."
+  Range,
   /// "=="
   EqEq,
   /// "!="
@@ -349,6 +365,10 @@ struct Token {
   [[nodiscard]]
   inline bool is_dot() const { return kind == Dot; };
 
+  /// Determine if this token is a range or not.
+  [[nodiscard]]
+  inline bool is_range() const { return kind == Range; };
+
   /// Returns a string representation of this token.
   [[nodiscard]]
   std::string to_str();
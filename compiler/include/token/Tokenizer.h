@@ -30,6 +30,15 @@ class Tokenizer {
   [[nodiscard]]
   const char peek_three() const;
 
+  /// Skip ahead to a position in the stream, updating the line and column.
+  ///
+  /// Newlines are located with `memchr`, which is vectorized by the C library,
+  /// so long comments and strings are not walked a byte at a time.
+  void skip_to(std::size_t pos);
+
+  /// Lex the rest of a numerical literal into `value`, including any type suffix like `u8` or `f64`.
+  void lex_number(std::string &value, LiteralKind &lit_kind);
+
   [[nodiscard]]
   inline const bool is_newl();
 
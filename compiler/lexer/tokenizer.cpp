@@ -1,4 +1,5 @@
 #include <cstdio>
+#include <cstring>
 #include <string>
 
 #include "../include/core/Logger.h"
@@ -36,16 +37,12 @@ const struct Token Tokenizer::advance_token() {
     /// Slash, division assignment, or comment. Currently discard comments until doc support.
     case '/':
       if (peek() == '/') {
-        while (src[iter] != '\n') {
-          iter++;
-          col++;
-        }
+        const char *newl = static_cast<const char *>(memchr(src.data() + iter, '\n', len - iter));
+        skip_to(newl ? newl - src.data() : len);
         return advance_token();
       } else if (peek() == '*') {
-        while (iter < len && src[iter] != '*' && peek() != '/') {
-          iter++;
-          col++;
-        }
+        const std::size_t close = src.find("*/", iter + 2);
+        skip_to(close == std::string::npos ? len : close + 2);
         return advance_token();
       } else if (peek() == '=') {
         kind = SlashEq;
@@ -85,14 +82,7 @@ const struct Token Tokenizer::advance_token() {
         iter++;
         col++;
 
-        while (isdigit(src[iter]) || src[iter] == '.') {
-          if (src[iter] == '.' && lit_kind == Integer) {
-            lit_kind = Float;
-          }
-          value.push_back(src[iter]);
-          iter++;
-          col++;
-        }
+        lex_number(value, lit_kind);
         return Token(kind, meta, value, lit_kind);
       }
       kind = Sub;
@@ -125,22 +115,29 @@ const struct Token Tokenizer::advance_token() {
       break;
 
     /// String literals.
-    case '"':
+    case '"': {
       kind = Literal;
       lit_kind = String;
 
-      while (peek() != '"') {
-        iter++;
-        col++;
-        value.push_back(src[iter]);
+      const char *close = static_cast<const char *>(memchr(src.data() + iter + 1, '"', len - iter - 1));
+      if (!close) {
+        panic("unterminated string literal", meta);
       }
-      iter++;
-      col++;
+
+      const std::size_t end = close - src.data();
+      value.assign(src, iter + 1, end - iter - 1);
+      skip_to(end);
       break;
+    }
 
-    /// Dots.
+    /// Dots or ranges.
     case '.':
       kind = Dot;
+      if (peek() == '.') {
+        kind = Range;
+        iter++;
+        col++;
+      }
       break;
 
     /// Equals, fat arrows, or comparison.
@@ -246,14 +243,7 @@ const struct Token Tokenizer::advance_token() {
         kind = Literal;
         lit_kind = Integer;
 
-        while (isdigit(src[iter]) || src[iter] == '.') {
-          if (src[iter] == '.' && lit_kind == Integer) {
-            lit_kind = Float;
-          }
-          value.push_back(src[iter]);
-          iter++;
-          col++;
-        }
+        lex_number(value, lit_kind);
         return Token(kind, meta, value, lit_kind);
       }
       panic("unresolved sequence: " + std::string(1, chr), meta);
@@ -274,6 +264,42 @@ const struct Token Tokenizer::advance_token() {
 
 }
 
+void Tokenizer::lex_number(std::string &value, LiteralKind &lit_kind) {
+  while (isdigit(src[iter]) || (src[iter] == '.' && src[iter + 1] != '.')) {
+    if (src[iter] == '.' && lit_kind == Integer) {
+      lit_kind = Float;
+    }
+    value.push_back(src[iter]);
+    iter++;
+    col++;
+  }
+
+  // type suffix, like `u8` or `f64`
+  if ((src[iter] == 'i' || src[iter] == 'u' || src[iter] == 'f') && isdigit(src[iter + 1])) {
+    if (src[iter] == 'f') {
+      lit_kind = Float;
+    }
+
+    while (isalnum(src[iter])) {
+      value.push_back(src[iter]);
+      iter++;
+      col++;
+    }
+  }
+}
+
+void Tokenizer::skip_to(std::size_t pos) {
+  const char *curr = src.data() + iter;
+  const char *end = src.data() + pos;
+  while (const char *newl = static_cast<const char *>(memchr(curr, '\n', end - curr))) {
+    line++;
+    col = 1;
+    curr = newl + 1;
+  }
+  col += end - curr;
+  iter = pos;
+}
+
 const char Tokenizer::peek() const {
   return iter + 1 < len ? src[iter + 1] : '\0';
 }
@@ -310,6 +336,7 @@ std::string Token::to_str() {
     case Sub: return "Sub";
     case Arrow: return "Arrow";
     case Dot: return "Dot";
+    case Range: return "Range";
     case Eq: return "Eq";
     case NotEq: return "NotEq";
     case FatArrow: return "FatArrow";
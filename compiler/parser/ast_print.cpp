@@ -5,9 +5,10 @@
 #include "../include/ast/Stmt.h"
 #include "../include/ast/Unit.h"
 
-static int indent = 0;
-static bool at_last_child = false;
-static std::vector<int> place_vert = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+// sessions of the library may print on several threads at once, so the piping state is kept per thread
+static thread_local int indent = 0;
+static thread_local bool at_last_child = false;
+static thread_local std::vector<int> place_vert = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
 
 static const std::string RESET = "\033[0m";
 static const std::string RED = "\033[31m";
@@ -70,15 +71,26 @@ static std::string binary_to_string(BinaryOp op) {
 
 const std::string CrateUnit::to_string() {
   std::string result;
-  for (std::unique_ptr<PackageUnit> const &package : packages) {
-    at_last_child = package == packages.back();
-    result += package->to_string() + '\n';
+  for (const std::string &unit : to_units()) {
+    result += unit;
   }
-  at_last_child = false;
   return result;
 }
 
 
+const std::vector<std::string> CrateUnit::to_units() {
+  // each unit starts from a clean piping state, so it does not depend on the packages printed before it
+  std::vector<std::string> results;
+  for (std::unique_ptr<PackageUnit> const &pkg : packages) {
+    indent = 0;
+    at_last_child = false;
+    std::fill(place_vert.begin(), place_vert.end(), 0);
+    results.push_back(pkg->to_string() + '\n');
+  }
+  return results;
+}
+
+
 const std::string PackageUnit::to_string() {
   std::string result = BOLD + YELLOW + "PackageUnit " + RESET + BLUE + name + RESET;
   if (imports.size() > 0) {
@@ -102,7 +114,16 @@ const std::string PackageUnit::to_string() {
 const std::string FunctionDecl::to_string() {
   const std::string type = get_type() ? get_type()->to_string() : "void";
   std::string result = piping() + BOLD + RED + "FunctionDecl" + RESET + GREEN + " '" + type + "' " + BLUE + name + RESET;
-  result = is_priv() ? result + " private\n" : result + '\n'; 
+  result = is_priv() ? result + " private" : result;
+  result = is_inline() ? result + YELLOW + " inline" + RESET : result;
+  if (is_async()) {
+    result += " async" + YELLOW + " states=" + std::to_string(suspend_points + 1) + " frame(";
+    for (NamedDecl *d : frame) {
+      result += d == frame.front() ? d->get_name() : ", " + d->get_name();
+    }
+    result += ")" + RESET;
+  }
+  result += '\n';
   indent++;
   for (std::unique_ptr<ParamVarDecl> &param : params) {
     result += param->to_string();
@@ -124,17 +145,22 @@ const std::string ParamVarDecl::to_string() {
 const std::string FieldDecl::to_string() {
   std::string result = piping() + RED + "FieldDecl" + GREEN + " '" + get_type()->to_string() + "' " + BLUE + name + RESET;
   if (is_priv()) {
-    result += " private\n";
-  } else {
-    result += '\n';
+    result += " private";
   }
+  result += " offset " + std::to_string(offset);
+  if (align) {
+    result += YELLOW + " align(" + std::to_string(align) + ")" + RESET;
+  }
+  result += cache_padded ? YELLOW + " cache_padded" + RESET + '\n' : "\n";
   return result;
 }
 
 
 const std::string StructDecl::to_string() {
-  std::string result = is_priv() ? piping() + BOLD + RED + "StructDecl " + RESET + GREEN + name + RESET + " private\n" : \
-    piping() + BOLD + RED + "StructDecl " + RESET + BLUE + name + RESET + '\n';
+  std::string result = is_priv() ? piping() + BOLD + RED + "StructDecl " + RESET + GREEN + name + RESET + " private" : \
+    piping() + BOLD + RED + "StructDecl " + RESET + BLUE + name + RESET;
+  result += soa ? YELLOW + " soa" + RESET : "";
+  result += " size " + std::to_string(size) + " align " + std::to_string(align) + '\n';
   indent++;
   for (std::unique_ptr<FieldDecl> const &field : fields) {
     at_last_child = field == fields.back();
@@ -302,6 +328,38 @@ const std::string UntilStmt::to_string() {
 }
 
 
+const std::string ForStmt::to_string() {
+  std::string result = piping() + BOLD + MAGENTA + "ForStmt" + RESET;
+  result = is_parallel() ? result + " parallel" : result;
+  for (BinaryExpr *reduction : reductions) {
+    const DeclRefExpr *target = dynamic_cast<const DeclRefExpr *>(reduction->get_lhs());
+    result += YELLOW + " reduce(" + binary_to_string(reduction->get_op()) + " " + target->get_ident() + ")" + RESET;
+  }
+  for (const std::string &name : hoisted) {
+    result += CYAN + " hoist(" + name + ")" + RESET;
+  }
+  for (const std::string &name : columns) {
+    result += YELLOW + " column(" + name + ")" + RESET;
+  }
+  result += '\n';
+  indent++;
+  at_last_child = false;
+  unsigned base_indent = indent;
+  place_vert[indent] = 1;
+
+  result += var->to_string();
+  indent = base_indent;
+  result += lo->to_string();
+  indent = base_indent;
+  result += hi->to_string();
+  indent = base_indent;
+  at_last_child = true;
+  place_vert[indent] = 0;
+  result += body->to_string();
+  return result;
+}
+
+
 const std::string BreakStmt::to_string() {
   return piping() + BOLD + MAGENTA + "BreakStmt" + RESET + '\n';
 }
@@ -328,7 +386,8 @@ const std::string BooleanLiteral::to_string() {
 
 
 const std::string IntegerLiteral::to_string() {
-  return piping() + MAGENTA + "IntegerLiteral" + GREEN + " '" + get_type()->to_string() + "' " + BOLD + CYAN + std::to_string(value) + RESET + '\n';
+  const std::string val = value < 0 && !signedness ? std::to_string(static_cast<unsigned long long>(value)) : std::to_string(value);
+  return piping() + MAGENTA + "IntegerLiteral" + GREEN + " '" + get_type()->to_string() + "' " + BOLD + CYAN + val + RESET + '\n';
 }
 
 
@@ -343,7 +402,9 @@ const std::string CharLiteral::to_string() {
 
 
 const std::string StringLiteral::to_string() {
-  return piping() + MAGENTA + "StringLiteral" + GREEN + " '" + get_type()->to_string() + "' " + BOLD + CYAN + "\"" + value + "\"" + RESET + '\n';
+  std::string result = piping() + MAGENTA + "StringLiteral" + GREEN + " '" + get_type()->to_string() + "' " + BOLD + CYAN + "\"" + value + "\"" + RESET;
+  result += YELLOW + " .str." + std::to_string(id) + RESET;
+  return is_inline() ? result + " inline\n" : result + '\n';
 }
 
 
@@ -414,11 +475,91 @@ const std::string InitExpr::to_string() {
 
 
 const std::string MemberExpr::to_string() {
-  std::string result = get_type() ? piping() + MAGENTA + "MemberExpr" + GREEN + " '" + get_type()->to_string() + "' " + BLUE + '\'' + get_member() + '\'' + RESET + '\n' \
-    : piping() + MAGENTA + "MemberExpr " + BLUE + '\'' + get_member() + '\'' + RESET + '\n';
+  std::string result = get_type() ? piping() + MAGENTA + "MemberExpr" + GREEN + " '" + get_type()->to_string() + "' " + BLUE + '\'' + get_member() + '\'' + RESET \
+    : piping() + MAGENTA + "MemberExpr " + BLUE + '\'' + get_member() + '\'' + RESET;
+  result += soa ? YELLOW + " soa" + RESET + '\n' : "\n";
+  indent++;
+  at_last_child = true;
+  result += base->to_string();
+  at_last_child = false;
+  return result;
+}
+
+
+const std::string VectorExpr::to_string() {
+  std::string result = piping() + MAGENTA + "VectorExpr" + GREEN + " '" + get_type()->to_string() + '\'' + \
+    (is_splat() ? BOLD + CYAN + " splat" : "") + RESET + '\n';
+  indent++;
+  for (std::unique_ptr<Expr> const &lane : lanes) {
+    at_last_child = lane == lanes.back();
+    result += lane->to_string();
+  }
+  at_last_child = false;
+  return result;
+}
+
+
+const std::string ArrayExpr::to_string() {
+  const std::string type = get_type() ? get_type()->to_string() : "unknown";
+  std::string result = piping() + MAGENTA + "ArrayExpr" + GREEN + " '" + type + '\'' + RESET + '\n';
+  indent++;
+  for (std::unique_ptr<Expr> const &element : elements) {
+    at_last_child = element == elements.back();
+    result += element->to_string();
+  }
+  at_last_child = false;
+  return result;
+}
+
+
+const std::string MapExpr::to_string() {
+  const std::string type = get_type() ? get_type()->to_string() : "unknown";
+  std::string result = piping() + MAGENTA + "MapExpr" + GREEN + " '" + type + '\'' + RESET + '\n';
+  indent++;
+  for (std::size_t i = 0; i < keys.size(); i++) {
+    at_last_child = false;
+    result += keys[i]->to_string();
+    at_last_child = i == keys.size() - 1;
+    result += values[i]->to_string();
+  }
+  at_last_child = false;
+  return result;
+}
+
+
+const std::string IndexExpr::to_string() {
+  const std::string type = get_type() ? get_type()->to_string() : "unknown";
+  std::string result = piping() + MAGENTA + "IndexExpr" + GREEN + " '" + type + '\'' + RESET;
+  if (bounds == BoundsHoisted) {
+    result += BOLD + CYAN + " hoisted" + RESET;
+  } else if (bounds == BoundsElided) {
+    result += BOLD + CYAN + " unchecked" + RESET;
+  }
+  result += '\n';
   indent++;
+  at_last_child = false;
+  result += base->to_string();
   at_last_child = true;
+  result += index->to_string();
+  at_last_child = false;
+  return result;
+}
+
+
+const std::string SliceExpr::to_string() {
+  const std::string type = get_type() ? get_type()->to_string() : "unknown";
+  std::string result = piping() + MAGENTA + "SliceExpr" + GREEN + " '" + type + '\'' + RESET + '\n';
+  indent++;
+  at_last_child = !lo && !hi;
   result += base->to_string();
+  if (lo) {
+    at_last_child = !hi;
+    result += lo->to_string();
+  }
+  if (hi) {
+    at_last_child = true;
+    result += hi->to_string();
+  }
   at_last_child = false;
   return result;
 }
@@ -443,3 +584,55 @@ const std::string ThisExpr::to_string() {
   return get_type() ? piping() + MAGENTA + "ThisExpr" + GREEN + " '" + get_type()->to_string() + "' " + BOLD + CYAN + "this" + RESET + '\n' \
     : piping() + MAGENTA + "ThisExpr" + GREEN + " 'unknown' " + BOLD + CYAN + "this" + RESET + '\n';
 }
+
+
+const std::string AwaitExpr::to_string() {
+  const std::string type = get_type() ? get_type()->to_string() : "void";
+  std::string result = piping() + MAGENTA + "AwaitExpr" + GREEN + " '" + type + "' " + BOLD + CYAN + "state " + std::to_string(state) + RESET + '\n';
+  indent++;
+  at_last_child = true;
+  result += expr->to_string();
+  at_last_child = false;
+  return result;
+}
+
+
+const std::string CastExpr::to_string() {
+  std::string result = piping() + MAGENTA + "CastExpr" + GREEN + " '" + get_type()->to_string() + '\'' + RESET + '\n';
+  indent++;
+  at_last_child = true;
+  result += expr->to_string();
+  at_last_child = false;
+  return result;
+}
+
+
+const std::string SpawnExpr::to_string() {
+  const std::string type = get_type() ? get_type()->to_string() : "unknown";
+  std::string result = piping() + MAGENTA + "SpawnExpr" + GREEN + " '" + type + "'" + RESET + '\n';
+  indent++;
+  at_last_child = true;
+  result += expr->to_string();
+  at_last_child = false;
+  return result;
+}
+
+
+const std::string PrintExpr::to_string() {
+  std::string result = piping() + MAGENTA + "PrintExpr " + BLUE + (newline ? "'println'" : "'print'") + BOLD + CYAN + \
+    " \"" + format + "\"" + RESET;
+  for (std::size_t i = 0; i < pieces.size(); i++) {
+    if (!pieces.at(i).empty()) {
+      result += YELLOW + " .str." + std::to_string(ids.at(i)) + RESET;
+    }
+  }
+  result += '\n';
+
+  indent++;
+  for (std::unique_ptr<Expr> const &arg : args) {
+    at_last_child = arg == args.back();
+    result += arg->to_string();
+  }
+  at_last_child = false;
+  return result;
+}
@@ -1,6 +1,9 @@
 /// This source file houses the main recursive descent parsing functions for the AST builder.
 
+#include <cctype>
+#include <climits>
 #include <memory>
+#include <stdexcept>
 
 #include "../include/ast/Builder.h"
 #include "../include/ast/Decl.h"
@@ -10,12 +13,13 @@
 #include "../include/core/Logger.h"
 #include "../include/core/Utils.h"
 
-static std::shared_ptr<Scope> curr_scope;
+static thread_local std::shared_ptr<Scope> curr_scope;
 
 static std::unique_ptr<Expr> parse_expr(std::unique_ptr<ASTContext> &ctx);
 static std::unique_ptr<Stmt> parse_stmt(std::unique_ptr<ASTContext> &ctx);
 static std::unique_ptr<Stmt> parse_var_decl(std::unique_ptr<ASTContext> &ctx);
 static std::unique_ptr<Expr> parse_primary_expr(std::unique_ptr<ASTContext> &ctx);
+static std::unique_ptr<Expr> parse_member_expr(std::unique_ptr<ASTContext> &ctx, std::unique_ptr<Expr> base);
 
 static UnaryOp get_unary_op(TokenKind op) {
   switch (op) {
@@ -114,6 +118,155 @@ static int get_precedence(TokenKind op) {
 }
 
 
+/// Returns true if the given token may begin a type.
+static bool is_type_start(const struct Token &tok) {
+  return tok.is_ident() || tok.is_open_bracket() || tok.is_hash();
+}
+
+
+/// Returns true if the given name is taken by a builtin type, like `i64`, `Ordering` or `MappedFile`.
+static bool is_builtin_type_name(std::unique_ptr<ASTContext> &ctx, const std::string &name) {
+  return ctx->has_type(name) && !dynamic_cast<TypeRef *>(ctx->resolve_type(name));
+}
+
+
+/// Parses the constant length in an array or channel type, which must be a positive integer.
+static unsigned int parse_type_len(std::unique_ptr<ASTContext> &ctx, const std::string &what) {
+  if (!ctx->last().is_int() || ctx->last().value.find_first_not_of("0123456789") != std::string::npos) {
+    panic("expected " + what, ctx->last().meta);
+  }
+
+  // lengths which do not fit are reported rather than wrapped
+  unsigned long len = 0;
+  try {
+    len = std::stoul(ctx->last().value);
+  } catch (const std::out_of_range &) {
+    len = ULONG_MAX;
+  }
+  if (len > UINT_MAX) {
+    panic(what + " out of range: " + ctx->last().value, ctx->last().meta);
+  } else if (len == 0) {
+    panic(what + " of 0", ctx->last().meta);
+  }
+  ctx->next();  // eat length
+  return static_cast<unsigned int>(len);
+}
+
+
+/// Parses a type from the given context.
+///
+/// Types are either identifiers, like `i64` and `Foo`, builtin generic types, like `task<i64>` and
+/// `chan<i64; 64>`, array and slice types, like `[i32; 4]` and `[u8]`, or runes, like `#i64`.
+static Type *parse_type(std::unique_ptr<ASTContext> &ctx) {
+  if (ctx->last().is_hash()) {
+    const Metadata meta = ctx->last().meta;
+    ctx->next();  // eat hash
+
+    if (!is_type_start(ctx->last())) {
+      panic("expected type after '#'", ctx->last().meta);
+    }
+
+    const Type *T = parse_type(ctx);
+    if (!T) {
+      panic("rune of void", meta);
+    }
+    return ctx->resolve_rune_type(T);
+  }
+
+  if (ctx->last().is_open_bracket()) {
+    const Metadata meta = ctx->last().meta;
+    ctx->next();  // eat open bracket
+
+    if (!is_type_start(ctx->last())) {
+      panic("expected element type in array or slice type", ctx->last().meta);
+    }
+
+    const Type *T = parse_type(ctx);
+    if (!T) {
+      panic("array or slice of void", meta);
+    }
+
+    // slice types have no length
+    if (ctx->last().is_close_bracket()) {
+      ctx->next();  // eat close bracket
+      return ctx->resolve_slice_type(T);
+    }
+
+    if (!ctx->last().is_semi()) {
+      panic("expected ';' or ']' in array or slice type", ctx->last().meta);
+    }
+    ctx->next();  // eat semi
+
+    const unsigned int len = parse_type_len(ctx, "array length");
+
+    if (!ctx->last().is_close_bracket()) {
+      panic("expected ']' after array length", ctx->last().meta);
+    }
+    ctx->next();  // eat close bracket
+    return ctx->resolve_array_type(T, len);
+  }
+
+  const std::string name = ctx->last().value;
+  const Metadata meta = ctx->last().meta;
+  ctx->next();  // eat type identifier
+
+  if (!ctx->last().is_less_than()) {
+    return ctx->resolve_type(name);
+  }
+  ctx->next();  // eat open angle
+
+  // channels take a capacity after their element type, like arrays take a length
+  if (name == "chan") {
+    if (!is_type_start(ctx->last())) {
+      panic("expected element type in channel type", ctx->last().meta);
+    }
+
+    const Type *T = parse_type(ctx);
+    if (!T) {
+      panic("channel of void", meta);
+    }
+
+    if (!ctx->last().is_semi()) {
+      panic("expected ';' after channel element type", ctx->last().meta);
+    }
+    ctx->next();  // eat semi
+
+    const Metadata cap_meta = ctx->last().meta;
+    const unsigned int cap = parse_type_len(ctx, "channel capacity");
+    if ((cap & (cap - 1)) != 0) {
+      panic("channel capacity must be a power of two: " + std::to_string(cap), cap_meta);
+    }
+
+    if (!ctx->last().is_greater_than()) {
+      panic("expected '>' after channel capacity", ctx->last().meta);
+    }
+    ctx->next();  // eat close angle
+    return ctx->resolve_chan_type(T, cap);
+  }
+
+  std::vector<const Type *> params;
+  while (!ctx->last().is_greater_than()) {
+    if (!is_type_start(ctx->last())) {
+      panic("expected type parameter in generic type: " + name, ctx->last().meta);
+    }
+    params.push_back(parse_type(ctx));
+
+    if (ctx->last().is_comma()) {
+      ctx->next();  // eat comma
+    } else if (!ctx->last().is_greater_than()) {
+      panic("expected ',' or '>' in generic type: " + name, ctx->last().meta);
+    }
+  }
+  ctx->next();  // eat close angle
+
+  Type *T = ctx->resolve_generic_type(name, params);
+  if (!T) {
+    panic("unknown generic type: " + name, meta);
+  }
+  return T;
+}
+
+
 /// Parses a numerical expression from the given context.
 ///
 /// Numerical expressions count as integer and floating point literals.
@@ -121,10 +274,41 @@ static std::unique_ptr<Expr> parse_numerical_expr(std::unique_ptr<ASTContext> &c
   struct Token token = ctx->last();
   ctx->next();  // eat the literal
 
+  // split the type suffix, if any, from the digits
+  std::string digits = token.value;
+  std::string suffix = "";
+  const std::size_t suffix_pos = digits.find_first_of("iuf");
+  if (suffix_pos != std::string::npos) {
+    suffix = digits.substr(suffix_pos);
+    digits = digits.substr(0, suffix_pos);
+  }
+
+  const PrimitiveType *T = nullptr;
+  if (!suffix.empty()) {
+    T = ctx->has_type(suffix) ? dynamic_cast<const PrimitiveType *>(ctx->resolve_type(suffix)) : nullptr;
+    if (!T || T->is_bool() || (!T->is_integer() && !T->is_float())) {
+      return warn_expr("invalid literal suffix: " + suffix, token.meta);
+    }
+  }
+
   if (token.is_int()) {
-    return std::make_unique<IntegerLiteral>(std::stoll(token.value), ctx->resolve_type("i64"), token.meta);
+    if (T && T->is_float()) {
+      return std::make_unique<FPLiteral>(std::stod(digits), true, T, token.meta);
+    }
+
+    // values above the range of i64 are kept wrapped, for u64
+    try {
+      const bool negative = digits[0] == '-';
+      const long long value = negative ? std::stoll(digits) : static_cast<long long>(std::stoull(digits));
+      return std::make_unique<IntegerLiteral>(value, negative, T != nullptr, T ? T : ctx->resolve_type("i64"), token.meta);
+    } catch (const std::out_of_range &) {
+      return warn_expr("integer literal out of range: " + token.value, token.meta);
+    }
   } else if (token.is_float()) {
-    return std::make_unique<FPLiteral>(std::stod(token.value), ctx->resolve_type("float"), token.meta);
+    if (T && !T->is_float()) {
+      return warn_expr("invalid suffix for floating point literal: " + suffix, token.meta);
+    }
+    return std::make_unique<FPLiteral>(std::stod(digits), T != nullptr, T ? T : ctx->resolve_type("f32"), token.meta);
   }
 
   return warn_expr("unknown literal kind: " + std::to_string(token.kind), token.meta);
@@ -154,7 +338,7 @@ static std::unique_ptr<Expr> parse_string_expr(std::unique_ptr<ASTContext> &ctx)
   ctx->next();  // eat the string or byte string token
 
   if (token.is_str()) {
-    return std::make_unique<StringLiteral>(token.value, ctx->resolve_type("str"), token.meta);
+    return std::make_unique<StringLiteral>(token.value, ctx->intern_str(token.value), ctx->resolve_type("str"), token.meta);
   }
 
   return warn_expr("unknown string or byte string kind: " + std::to_string(token.kind), ctx->last().meta);
@@ -206,6 +390,219 @@ static std::unique_ptr<Expr> parse_call_expr(std::unique_ptr<ASTContext> &ctx, c
 }
 
 
+/// Parses a call to the builtin `print` or `println` from the given context.
+///
+/// Prints are in the form `print("<format>", ...)`. The format string is split into literal pieces around its
+/// placeholders here, and `{{` and `}}` escape literal braces.
+static std::unique_ptr<Expr> parse_print_expr(std::unique_ptr<ASTContext> &ctx, bool newline, const Metadata &meta) {
+  ctx->next();  // eat the open parenthesis
+
+  if (!ctx->last().is_str()) {
+    return warn_expr("expected format string in print", ctx->last().meta);
+  }
+  const std::string format = ctx->last().value;
+  const Metadata format_meta = ctx->last().meta;
+  ctx->next();  // eat format string
+
+  std::vector<std::string> pieces = { "" };
+  std::vector<std::string> specs;
+  for (std::size_t i = 0; i < format.size(); i++) {
+    const char c = format.at(i);
+    if ((c == '{' || c == '}') && i + 1 < format.size() && format.at(i + 1) == c) {
+      pieces.back() += c;
+      i++;
+      continue;
+    } else if (c == '}') {
+      panic("unmatched '}' in format string", format_meta);
+    } else if (c != '{') {
+      pieces.back() += c;
+      continue;
+    }
+
+    const std::size_t close = format.find('}', i);
+    if (close == std::string::npos) {
+      panic("unmatched '{' in format string", format_meta);
+    }
+
+    // specifiers are empty, `:x`, or `:.N` with N a single digit
+    const std::string spec = format.substr(i + 1, close - i - 1);
+    if (!spec.empty() && spec != ":x" && !(spec.size() == 3 && spec.at(1) == '.' && std::isdigit(spec.at(2)))) {
+      panic("invalid format specifier: {" + spec + "}", format_meta);
+    }
+    specs.push_back(spec.empty() ? spec : spec.substr(1));
+    pieces.push_back("");
+    i = close;
+  }
+
+  std::vector<std::unique_ptr<Expr>> args;
+  while (ctx->last().is_comma()) {
+    ctx->next();  // eat comma
+
+    std::unique_ptr<Expr> arg = parse_expr(ctx);
+    if (!arg) {
+      return warn_expr("expected expression in print", ctx->last().meta);
+    }
+    args.push_back(std::move(arg));
+  }
+
+  if (!ctx->last().is_close_paren()) {
+    return warn_expr("expected ',' or ')' in print", ctx->last().meta);
+  }
+  ctx->next();  // eat the close parenthesis
+
+  if (args.size() != specs.size()) {
+    panic("format string has " + std::to_string(specs.size()) + " placeholders but " + \
+    std::to_string(args.size()) + " arguments were provided", meta);
+  }
+
+  std::vector<unsigned int> ids;
+  for (const std::string &piece : pieces) {
+    ids.push_back(ctx->intern_str(piece));
+  }
+  return std::make_unique<PrintExpr>(format, pieces, ids, specs, std::move(args), newline, meta);
+}
+
+
+/// Parses a vector construction expression from the given context.
+///
+/// Vector constructions are in the form of `<vector type>(<lanes>)`.
+static std::unique_ptr<Expr> parse_vector_expr(std::unique_ptr<ASTContext> &ctx, const VectorType *T, const Metadata &meta) {
+  ctx->next();  // eat the open parenthesis
+
+  std::vector<std::unique_ptr<Expr>> lanes;
+  while (!ctx->last().is_close_paren()) {
+    std::unique_ptr<Expr> lane = parse_expr(ctx);
+    if (!lane) {
+      return warn_expr("expected expression in vector construction", ctx->last().meta);
+    }
+    lanes.push_back(std::move(lane));
+
+    if (ctx->last().is_close_paren()) {
+      break;
+    }
+
+    if (!ctx->last().is_comma()) {
+      return warn_expr("expected ','", ctx->last().meta);
+    }
+
+    ctx->next();  // eat comma
+  }
+  ctx->next();  // eat the close parenthesis
+
+  if (lanes.size() != 1 && lanes.size() != T->get_lanes()) {
+    return warn_expr("vector " + T->to_string() + " has " + std::to_string(T->get_lanes()) + " lanes but " + \
+      std::to_string(lanes.size()) + " were provided", meta);
+  }
+
+  return std::make_unique<VectorExpr>(std::move(lanes), T, meta);
+}
+
+
+/// Parses an array or map literal from the given context.
+///
+/// Array literals are in the form of `[<elements>]`, and map literals in the form of `[<key>: <value>, ...]`.
+static std::unique_ptr<Expr> parse_array_expr(std::unique_ptr<ASTContext> &ctx) {
+  const Metadata meta = ctx->last().meta;
+  ctx->next();  // eat the open bracket
+
+  std::vector<std::unique_ptr<Expr>> elements;
+  std::vector<std::unique_ptr<Expr>> values;
+  while (!ctx->last().is_close_bracket()) {
+    std::unique_ptr<Expr> element = parse_expr(ctx);
+    if (!element) {
+      return warn_expr("expected expression in array literal", ctx->last().meta);
+    }
+    elements.push_back(std::move(element));
+
+    // a colon after the first key makes the literal a map, and then every entry needs one
+    if ((elements.size() == 1 && ctx->last().is_colon()) || !values.empty()) {
+      if (!ctx->last().is_colon()) {
+        return warn_expr("expected ':' in map literal", ctx->last().meta);
+      }
+      ctx->next();  // eat colon
+
+      std::unique_ptr<Expr> value = parse_expr(ctx);
+      if (!value) {
+        return warn_expr("expected expression in map literal", ctx->last().meta);
+      }
+      values.push_back(std::move(value));
+    }
+
+    if (ctx->last().is_close_bracket()) {
+      break;
+    }
+
+    if (!ctx->last().is_comma()) {
+      return warn_expr("expected ','", ctx->last().meta);
+    }
+
+    ctx->next();  // eat comma
+  }
+  ctx->next();  // eat the close bracket
+
+  if (elements.empty()) {
+    return warn_expr("empty array literal", meta);
+  } else if (!values.empty()) {
+    return std::make_unique<MapExpr>(std::move(elements), std::move(values), meta);
+  }
+
+  return std::make_unique<ArrayExpr>(std::move(elements), meta);
+}
+
+
+/// Parses any index and slice expressions on the given base from the given context.
+///
+/// Index expressions are in the form of `<base>[<index>]`, and slice expressions in the form of
+/// `<base>[<lo>..<hi>]`, where either bound may be left out.
+static std::unique_ptr<Expr> parse_index_expr(std::unique_ptr<ASTContext> &ctx, std::unique_ptr<Expr> base) {
+  while (ctx->last().is_open_bracket()) {
+    const Metadata meta = ctx->last().meta;
+    ctx->next();  // eat the open bracket
+
+    std::unique_ptr<Expr> lo = nullptr;
+    if (!ctx->last().is_range()) {
+      lo = parse_expr(ctx);
+      if (!lo) {
+        return warn_expr("expected index expression", ctx->last().meta);
+      }
+    }
+
+    if (ctx->last().is_range()) {
+      ctx->next();  // eat range
+
+      std::unique_ptr<Expr> hi = nullptr;
+      if (!ctx->last().is_close_bracket()) {
+        hi = parse_expr(ctx);
+        if (!hi) {
+          return warn_expr("expected upper bound in slice expression", ctx->last().meta);
+        }
+      }
+
+      if (!ctx->last().is_close_bracket()) {
+        return warn_expr("expected ']' after slice expression", ctx->last().meta);
+      }
+      ctx->next();  // eat the close bracket
+
+      base = std::make_unique<SliceExpr>(std::move(base), std::move(lo), std::move(hi), meta);
+      continue;
+    }
+
+    if (!ctx->last().is_close_bracket()) {
+      return warn_expr("expected ']' after index expression", ctx->last().meta);
+    }
+    ctx->next();  // eat the close bracket
+
+    base = std::make_unique<IndexExpr>(std::move(base), std::move(lo), meta);
+  }
+
+  // fields and methods of elements, like `a[i].x`
+  if (dynamic_cast<IndexExpr *>(base.get()) && ctx->last().is_dot()) {
+    return parse_member_expr(ctx, std::move(base));
+  }
+  return base;
+}
+
+
 /// Parses a struct construction expression from the given context.
 static std::unique_ptr<Expr> parse_init_expr(std::unique_ptr<ASTContext> &ctx, const std::string &ident, const Metadata &meta) {
   ctx->next();  // eat open brace
@@ -310,8 +707,8 @@ static std::unique_ptr<Expr> parse_member_expr(std::unique_ptr<ASTContext> &ctx,
   // verify that the base exists in this scope, if the base is not a member access
   if (DeclRefExpr *dre_base = dynamic_cast<DeclRefExpr *>(base.get())) {
     // verify the base references a variable declaration
-    VarDecl *str_decl = dynamic_cast<VarDecl *>(curr_scope->get_decl(dre_base->get_ident()));
-    if (!str_decl) {
+    NamedDecl *str_decl = curr_scope->get_decl(dre_base->get_ident());
+    if (!dynamic_cast<VarDecl *>(str_decl) && !dynamic_cast<ParamVarDecl *>(str_decl)) {
       return warn_expr("expected struct type: " + dre_base->get_ident(), ctx->last().meta);
     }
   }
@@ -347,6 +744,14 @@ static std::unique_ptr<Expr> parse_identifier_expr(std::unique_ptr<ASTContext> &
   ctx->next();  // eat the identifier
 
   if (ctx->last().is_open_paren()) {
+    if (ctx->has_type(token.value)) {
+      if (const VectorType *VT = dynamic_cast<const VectorType *>(ctx->resolve_type(token.value))) {
+        return parse_vector_expr(ctx, VT, token.meta);
+      }
+    }
+    if (token.value == "print" || token.value == "println") {
+      return parse_print_expr(ctx, token.value == "println", token.meta);
+    }
     return parse_call_expr(ctx, token.value, token.meta);
   } else if (ctx->last().is_dot()) {
     if (token.is_kw("this")) {
@@ -358,12 +763,15 @@ static std::unique_ptr<Expr> parse_identifier_expr(std::unique_ptr<ASTContext> &
     if (VarDecl *vd = dynamic_cast<VarDecl *>(curr_scope->get_decl(token.value))) {
       return parse_member_expr(ctx, std::make_unique<DeclRefExpr>(token.value, vd->get_type(), token.meta));
     }
+    if (ParamVarDecl *pd = dynamic_cast<ParamVarDecl *>(curr_scope->get_decl(token.value))) {
+      return parse_member_expr(ctx, std::make_unique<DeclRefExpr>(token.value, pd->get_type(), token.meta));
+    }
     return warn_expr("expected struct type: " + token.value, token.meta);
     
   } else if (VarDecl *d = dynamic_cast<VarDecl *>(curr_scope->get_decl(token.value))) {
-    return std::make_unique<DeclRefExpr>(token.value, d->get_type(), token.meta);
+    return parse_index_expr(ctx, std::make_unique<DeclRefExpr>(token.value, d->get_type(), token.meta));
   } else if (ParamVarDecl *d = dynamic_cast<ParamVarDecl *>(curr_scope->get_decl(token.value))) {
-    return std::make_unique<DeclRefExpr>(token.value, d->get_type(), token.meta);
+    return parse_index_expr(ctx, std::make_unique<DeclRefExpr>(token.value, d->get_type(), token.meta));
   } else if (ctx->last().is_path()) {
     ctx->next(); // ::
     if (!ctx->last().is_ident()) {
@@ -409,6 +817,46 @@ static std::unique_ptr<Expr> parse_unary_expr(std::unique_ptr<ASTContext> &ctx)
 }
 
 
+/// Parses an await expression from the given context.
+///
+/// Await expressions appear in the form `await <call>`.
+static std::unique_ptr<Expr> parse_await_expr(std::unique_ptr<ASTContext> &ctx) {
+  const Metadata meta = ctx->last().meta;
+  ctx->next();  // eat await keyword
+
+  std::unique_ptr<Expr> expr = parse_primary_expr(ctx);
+  if (!expr) {
+    return warn_expr("expected expression after 'await'", ctx->last().meta);
+  }
+
+  if (!dynamic_cast<CallExpr *>(expr.get())) {
+    return warn_expr("expected function call after 'await'", expr->get_meta());
+  }
+
+  return std::make_unique<AwaitExpr>(std::move(expr), meta);
+}
+
+
+/// Parses a spawn expression from the given context.
+///
+/// Spawn expressions appear in the form `spawn <call>`, and evaluate to a handle of the spawned task.
+static std::unique_ptr<Expr> parse_spawn_expr(std::unique_ptr<ASTContext> &ctx) {
+  const Metadata meta = ctx->last().meta;
+  ctx->next();  // eat spawn keyword
+
+  std::unique_ptr<Expr> expr = parse_primary_expr(ctx);
+  if (!expr) {
+    return warn_expr("expected expression after 'spawn'", ctx->last().meta);
+  }
+
+  if (!dynamic_cast<CallExpr *>(expr.get())) {
+    return warn_expr("expected function call after 'spawn'", expr->get_meta());
+  }
+
+  return std::make_unique<SpawnExpr>(std::move(expr), meta);
+}
+
+
 /// Parses a primary expression from the given context.
 ///
 /// Primary expressions are the most basic form of expressions.
@@ -434,6 +882,18 @@ static std::unique_ptr<Expr> parse_primary_expr(std::unique_ptr<ASTContext> &ctx
     return std::make_unique<NullExpr>(nullptr, ctx->last().meta);
   }
 
+  if (ctx->last().is_kw("await")) {
+    return parse_await_expr(ctx);
+  }
+
+  if (ctx->last().is_kw("spawn")) {
+    return parse_spawn_expr(ctx);
+  }
+
+  if (ctx->last().is_open_bracket()) {
+    return parse_array_expr(ctx);
+  }
+
   if (ctx->last().is_ident()) {
     return parse_identifier_expr(ctx);
   }
@@ -443,6 +903,24 @@ static std::unique_ptr<Expr> parse_primary_expr(std::unique_ptr<ASTContext> &ctx
 }
 
 
+/// Parses any cast expressions on the given operand from the given context.
+///
+/// Cast expressions are in the form of `<expr> as <type>`, and bind tighter than binary operators.
+static std::unique_ptr<Expr> parse_cast_expr(std::unique_ptr<ASTContext> &ctx, std::unique_ptr<Expr> base) {
+  while (ctx->last().is_kw("as")) {
+    const Metadata meta = ctx->last().meta;
+    ctx->next();  // eat as keyword
+
+    if (!ctx->last().is_ident()) {
+      return warn_expr("expected type after 'as'", ctx->last().meta);
+    }
+
+    base = std::make_unique<CastExpr>(std::move(base), parse_type(ctx), meta);
+  }
+  return base;
+}
+
+
 /// Parses a binary expression from the given context.
 ///
 /// Binary expressions are expressions that involve two operands.
@@ -466,6 +944,7 @@ static std::unique_ptr<Expr> parse_binary_expr(std::unique_ptr<ASTContext> &ctx,
     if (!rval) {
       return warn_expr("expected expression after binary operator", ctx->last().meta);
     }
+    rval = parse_cast_expr(ctx, std::move(rval));
 
     int next_prec = get_precedence(ctx->last().kind);
     if (token_prec < next_prec) {
@@ -475,7 +954,11 @@ static std::unique_ptr<Expr> parse_binary_expr(std::unique_ptr<ASTContext> &ctx,
       }
     }
 
-    base = std::make_unique<BinaryExpr>(oper, std::move(base), std::move(rval), base->get_meta());
+    std::unique_ptr<BinaryExpr> bin = std::make_unique<BinaryExpr>(oper, std::move(base), std::move(rval), base->get_meta());
+    if (is_comparison_op(oper)) {
+      bin->set_type(ctx->resolve_type("bool"));
+    }
+    base = std::move(bin);
   }
 }
 
@@ -486,7 +969,7 @@ static std::unique_ptr<Expr> parse_expr(std::unique_ptr<ASTContext> &ctx) {
   if (!base) {
     return warn_expr("expected expression", ctx->last().meta);
   }
-  return parse_binary_expr(ctx, std::move(base), 0);
+  return parse_binary_expr(ctx, parse_cast_expr(ctx, std::move(base)), 0);
 }
 
 
@@ -598,6 +1081,60 @@ static std::unique_ptr<Stmt> parse_until_stmt(std::unique_ptr<ASTContext> &ctx)
 }
 
 
+/// Parses a for statement from the given context.
+///
+/// For statements appear in the form `for <ident> in <expr>..<expr> { <stmt> }`, and are parallel
+/// when prefixed with `par`.
+static std::unique_ptr<Stmt> parse_for_stmt(std::unique_ptr<ASTContext> &ctx, bool parallel) {
+  const Metadata meta = ctx->last().meta;
+  ctx->next();  // eat for keyword
+
+  if (!ctx->last().is_ident()) {
+    return warn_stmt("expected identifier after 'for'", ctx->last().meta);
+  }
+
+  const std::string name = ctx->last().value;
+  const Metadata var_meta = ctx->last().meta;
+  ctx->next();  // eat induction variable
+
+  if (!ctx->last().is_kw("in")) {
+    return warn_stmt("expected 'in' after 'for' identifier", ctx->last().meta);
+  }
+  ctx->next();  // eat in keyword
+
+  std::unique_ptr<Expr> lo = parse_expr(ctx);
+  if (!lo) {
+    return warn_stmt("expected expression after 'in'", ctx->last().meta);
+  }
+
+  if (!ctx->last().is_range()) {
+    return warn_stmt("expected '..' in 'for' range", ctx->last().meta);
+  }
+  ctx->next();  // eat range
+
+  std::unique_ptr<Expr> hi = parse_expr(ctx);
+  if (!hi) {
+    return warn_stmt("expected expression after '..'", ctx->last().meta);
+  }
+
+  // declare new scope for the induction variable
+  std::shared_ptr<Scope> scope = std::make_shared<Scope>(curr_scope, ScopeContext{ .is_loop_scope = true });
+  curr_scope = scope;
+
+  std::unique_ptr<VarDecl> var = std::make_unique<VarDecl>(name, lo->get_type(), false, false, var_meta);
+  curr_scope->add_decl(var.get());
+
+  std::unique_ptr<Stmt> body = parse_stmt(ctx);
+  if (!body) {
+    return warn_stmt("expected statement after 'for' range", ctx->last().meta);
+  }
+
+  // move back up to the parent scope
+  curr_scope = curr_scope->get_parent();
+  return std::make_unique<ForStmt>(std::move(var), std::move(lo), std::move(hi), std::move(body), scope, parallel, meta);
+}
+
+
 /// Parses a match statement from the given context.
 ///
 /// Match statements appear in the form `match <expr> { case <expr> => <stmt>, ... }`.
@@ -698,6 +1235,18 @@ static std::unique_ptr<Stmt> parse_stmt(std::unique_ptr<ASTContext> &ctx) {
     return parse_until_stmt(ctx);
   }
 
+  else if (ctx->last().is_kw("for")) {
+    return parse_for_stmt(ctx, false);
+  }
+
+  else if (ctx->last().is_kw("par")) {
+    ctx->next();  // eat par keyword
+    if (!ctx->last().is_kw("for")) {
+      return warn_stmt("expected 'for' after 'par'", ctx->last().meta);
+    }
+    return parse_for_stmt(ctx, true);
+  }
+
   return parse_expr(ctx);
 }
 
@@ -734,19 +1283,18 @@ static std::unique_ptr<Stmt> parse_var_decl(std::unique_ptr<ASTContext> &ctx) {
     ctx->next();  // eat hash
   }
 
-  if (!ctx->last().is_ident()) {
+  if (!is_type_start(ctx->last())) {
     return warn_stmt("expected type identifier", ctx->last().meta);
   }
-  std::string type = ctx->last().value;
-  ctx->next();  // eat type
+  Type *type = parse_type(ctx);
 
   if (ctx->last().is_semi()) {
-    // prevent immutable empty declarations
-    if (!is_mutable) {
+    // prevent immutable empty declarations, except for channels which start empty
+    if (!is_mutable && !dynamic_cast<ChanType *>(type)) {
       return warn_stmt("immutable declaration must be initialized", ctx->last().meta);
     }
 
-    std::unique_ptr<VarDecl> decl = std::make_unique<VarDecl>(name, ctx->resolve_type(type), is_mutable, is_rune, meta);
+    std::unique_ptr<VarDecl> decl = std::make_unique<VarDecl>(name, type, is_mutable, is_rune, meta);
 
     // add declaration to parent scope
     curr_scope->add_decl(decl.get());
@@ -761,7 +1309,7 @@ static std::unique_ptr<Stmt> parse_var_decl(std::unique_ptr<ASTContext> &ctx) {
     return warn_stmt("expected expression after '='", ctx->last().meta);
   }
 
-  std::unique_ptr<VarDecl> decl = std::make_unique<VarDecl>(name, ctx->resolve_type(type), std::move(value), is_mutable, is_rune, meta);
+  std::unique_ptr<VarDecl> decl = std::make_unique<VarDecl>(name, type, std::move(value), is_mutable, is_rune, meta);
 
   // add declaration to parent scope
   curr_scope->add_decl(decl.get());
@@ -781,6 +1329,9 @@ static std::unique_ptr<TypeDecl> parse_enum_decl(std::unique_ptr<ASTContext> &ct
 
   const std::string name = ctx->last().value;
   const Metadata meta = ctx->last().meta;
+  if (is_builtin_type_name(ctx, name)) {
+    return warn_enum("redefinition of builtin type: " + name, meta);
+  }
   ctx->next();  // eat enum name
 
   if (!ctx->last().is_open_brace()) {
@@ -861,14 +1412,13 @@ static std::unique_ptr<NamedDecl> parse_fn_decl(std::unique_ptr<ASTContext> &ctx
 
     ctx->next();  // eat colon
 
-    if (!ctx->last().is_ident()) {
+    if (!is_type_start(ctx->last())) {
       return warn_fn("expected type in function parameter list", ctx->last().meta);
     }
 
-    const std::string param_type = ctx->last().value;
-    ctx->next();  // eat param type
+    Type *param_type = parse_type(ctx);
 
-    std::unique_ptr<ParamVarDecl> param = std::make_unique<ParamVarDecl>(param_name, ctx->resolve_type(param_type), param_meta);
+    std::unique_ptr<ParamVarDecl> param = std::make_unique<ParamVarDecl>(param_name, param_type, param_meta);
 
     if (curr_scope->get_decl(param_name)) {
       return warn_fn("parameter identifier already exists in scope: " + param_name, ctx->last().meta);
@@ -884,21 +1434,20 @@ static std::unique_ptr<NamedDecl> parse_fn_decl(std::unique_ptr<ASTContext> &ctx
   }
   ctx->next();  // eat close paren
 
-  std::string ret_type = "void";
+  Type *ret_type = nullptr;
   if (ctx->last().is_arrow()) {
     ctx->next();  // eat arrow
 
-    if (!ctx->last().is_ident()) {
+    if (!is_type_start(ctx->last())) {
       return warn_fn("expected return type in function declaration", ctx->last().meta);
     }
     
-    ret_type = ctx->last().value;
-    ctx->next();  // eat return type
+    ret_type = parse_type(ctx);
   }
 
   if (ctx->last().is_semi()) {
     ctx->next();  // eat semi
-    return std::make_unique<FunctionDecl>(name, ctx->resolve_type(ret_type), std::move(params), meta);
+    return std::make_unique<FunctionDecl>(name, ret_type, std::move(params), meta);
   }
 
   if (!ctx->last().is_open_brace() ) {
@@ -915,7 +1464,7 @@ static std::unique_ptr<NamedDecl> parse_fn_decl(std::unique_ptr<ASTContext> &ctx
   }
 
   std::unique_ptr<FunctionDecl> function = std::make_unique<FunctionDecl>(
-    name, ctx->resolve_type(ret_type), std::move(params), std::move(body), scope, meta);
+    name, ret_type, std::move(params), std::move(body), scope, meta);
 
   // move back to parent scope
   curr_scope = curr_scope->get_parent();
@@ -929,6 +1478,77 @@ static std::unique_ptr<NamedDecl> parse_fn_decl(std::unique_ptr<ASTContext> &ctx
 }
 
 
+/// Attr - An attribute in front of a declaration or a struct field.
+struct Attr final
+{
+  /// The name of the attribute.
+  std::string name;
+
+  /// The argument of the attribute, or 0 if it has none.
+  unsigned int value;
+
+  /// Metadata about the attribute.
+  Metadata meta;
+};
+
+
+/// Parses the attributes in front of a declaration or a struct field from the given context.
+///
+/// Attributes are in the form `#[<identifier>]` or `#[<identifier>(<integer>)]`.
+static std::vector<Attr> parse_attrs(std::unique_ptr<ASTContext> &ctx) {
+  std::vector<Attr> attrs;
+  while (ctx->last().is_hash()) {
+    const Metadata meta = ctx->last().meta;
+    ctx->next();  // eat hash
+
+    if (!ctx->last().is_open_bracket()) {
+      panic("expected '[' after '#' in attribute", ctx->last().meta);
+    }
+    ctx->next();  // eat open bracket
+
+    if (!ctx->last().is_ident()) {
+      panic("expected attribute name", ctx->last().meta);
+    }
+    const std::string name = ctx->last().value;
+    ctx->next();  // eat attribute name
+
+    unsigned int value = 0;
+    if (ctx->last().is_open_paren()) {
+      ctx->next();  // eat open paren
+      value = parse_type_len(ctx, "attribute argument");
+
+      if (!ctx->last().is_close_paren()) {
+        panic("expected ')' after attribute argument", ctx->last().meta);
+      }
+      ctx->next();  // eat close paren
+    }
+
+    if (!ctx->last().is_close_bracket()) {
+      panic("expected ']' after attribute", ctx->last().meta);
+    }
+    ctx->next();  // eat close bracket
+
+    attrs.push_back({ name, value, meta });
+  }
+  return attrs;
+}
+
+
+/// Returns the alignment requested by an `#[align(N)]` attribute.
+///
+/// Alignments are powers of two no larger than a page.
+static unsigned int get_attr_align(const Attr &attr) {
+  if (attr.value == 0) {
+    panic("expected alignment in attribute: align", attr.meta);
+  } else if ((attr.value & (attr.value - 1)) != 0) {
+    panic("alignment must be a power of two: " + std::to_string(attr.value), attr.meta);
+  } else if (attr.value > StructLayout::max_align) {
+    panic("alignment exceeds " + std::to_string(StructLayout::max_align) + ": " + std::to_string(attr.value), attr.meta);
+  }
+  return attr.value;
+}
+
+
 /// Parses a struct declaration from the given context.
 ///
 /// Struct declarations are in the form of `struct <identifier> { <fields> }`.
@@ -941,6 +1561,9 @@ static std::unique_ptr<TypeDecl> parse_struct_decl(std::unique_ptr<ASTContext> &
 
   const std::string name = ctx->last().value;
   const Metadata meta = ctx->last().meta;
+  if (is_builtin_type_name(ctx, name)) {
+    return warn_tydecl("redefinition of builtin type: " + name, meta);
+  }
   ctx->next();  // eat struct name
 
   if (!ctx->last().is_open_brace()) {
@@ -955,6 +1578,7 @@ static std::unique_ptr<TypeDecl> parse_struct_decl(std::unique_ptr<ASTContext> &
   // parse fields and methods
   std::vector<std::unique_ptr<FieldDecl>> fields;
   while (!ctx->last().is_close_brace()) {
+    const std::vector<Attr> attrs = parse_attrs(ctx);
     if (!ctx->last().is_ident()) {
       return warn_tydecl("expected identifier", ctx->last().meta);
     }
@@ -974,12 +1598,11 @@ static std::unique_ptr<TypeDecl> parse_struct_decl(std::unique_ptr<ASTContext> &
     }
     ctx->next();  // eat colon
 
-    if (!ctx->last().is_ident()) {
+    if (!is_type_start(ctx->last())) {
       return warn_tydecl("expected type", ctx->last().meta);
     }
 
-    const std::string field_type = ctx->last().value;
-    ctx->next();  // eat field type
+    Type *field_type = parse_type(ctx);
 
     // verify that the field does not already exist
     for (const std::unique_ptr<FieldDecl> &f : fields) {
@@ -989,11 +1612,21 @@ static std::unique_ptr<TypeDecl> parse_struct_decl(std::unique_ptr<ASTContext> &
     }
 
     std::unique_ptr<FieldDecl> field = std::make_unique<FieldDecl>(
-      field_name, ctx->resolve_type(field_type), field_meta);
+      field_name, field_type, field_meta);
     if (is_private) {
       field->set_priv();
     }
 
+    for (const Attr &attr : attrs) {
+      if (attr.name == "align") {
+        field->set_align(get_attr_align(attr));
+      } else if (attr.name == "cache_padded" && attr.value == 0) {
+        field->set_cache_padded();
+      } else {
+        return warn_tydecl("unknown attribute for field: " + attr.name, attr.meta);
+      }
+    }
+
     // add field to struct scope
     curr_scope->add_decl(field.get());
     fields.push_back(std::move(field));
@@ -1104,6 +1737,12 @@ static std::unique_ptr<Decl> parse_impl_decl(std::unique_ptr<ASTContext> &ctx) {
       ctx->next();  // eat priv keyword
     }
 
+    bool is_async = false;
+    if (ctx->last().is_kw("async")) {
+      is_async = true;
+      ctx->next();  // eat async keyword
+    }
+
     ctx->set_add_next_to_scope(false);
     std::unique_ptr<NamedDecl> method = parse_fn_decl(ctx);
     
@@ -1121,6 +1760,10 @@ static std::unique_ptr<Decl> parse_impl_decl(std::unique_ptr<ASTContext> &ctx) {
     if (is_private) {
       method->set_priv();
     }
+
+    if (is_async) {
+      dynamic_cast<FunctionDecl *>(method.get())->set_async();
+    }
     methods.push_back(std::move(std::unique_ptr<FunctionDecl>(dynamic_cast<FunctionDecl *>(method.release()))));
   }
   ctx->next();  // eat close brace
@@ -1134,15 +1777,53 @@ static std::unique_ptr<Decl> parse_impl_decl(std::unique_ptr<ASTContext> &ctx) {
 ///
 /// Declarations are the top-level constructs in a package.
 static std::unique_ptr<Decl> parse_decl(std::unique_ptr<ASTContext> &ctx, bool is_private) {
+  if (ctx->last().is_hash()) {
+    const std::vector<Attr> attrs = parse_attrs(ctx);
+
+    std::unique_ptr<Decl> decl = parse_decl(ctx, is_private);
+    for (const Attr &attr : attrs) {
+      StructDecl *struct_d = dynamic_cast<StructDecl *>(decl.get());
+      if (attr.name == "soa" && struct_d && attr.value == 0) {
+        struct_d->set_soa();
+      } else if (attr.name == "align" && struct_d) {
+        struct_d->set_align(get_attr_align(attr));
+      } else {
+        return warn_decl("unknown attribute for declaration: " + attr.name, attr.meta);
+      }
+    }
+    return decl;
+  }
+
+  if (ctx->last().is_kw("async")) {
+    ctx->next();  // eat async keyword
+    if (!ctx->last().is_kw("fn")) {
+      return warn_decl("expected 'fn' after 'async'", ctx->last().meta);
+    }
+
+    std::unique_ptr<Decl> decl = parse_decl(ctx, is_private);
+    if (FunctionDecl *fn = dynamic_cast<FunctionDecl *>(decl.get())) {
+      fn->set_async();
+      return decl;
+    }
+    return warn_decl("expected function declaration", ctx->last().meta);
+  }
+
   if (ctx->last().is_kw("fn")) {
+    std::unique_ptr<NamedDecl> decl = parse_fn_decl(ctx);
+
+    // calls to `print` and `println` are parsed as builtin prints, so no function may take their names
+    if (decl && (decl->get_name() == "print" || decl->get_name() == "println")) {
+      return warn_decl("redefinition of builtin function: " + decl->get_name(), decl->get_meta());
+    }
+
     if (is_private) {
-      if (std::unique_ptr<NamedDecl> decl = parse_fn_decl(ctx)) {
+      if (decl) {
         decl->set_priv();
         return decl;
       }
       return warn_decl("expected function declaration", ctx->last().meta);
     }
-    return parse_fn_decl(ctx);
+    return decl;
   }
 
   if (ctx->last().is_kw("struct")) {
@@ -1,3 +1,5 @@
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include <algorithm>
@@ -9,37 +11,1462 @@
 #include "../include/core/Logger.h"
 #include "../include/sema/ASTVisitor.h"
 
-static std::vector<PackageUnit *> pkgs = {};
-static bool has_entry = false;
-static bool in_loop = false;
-static std::shared_ptr<Scope> pkg_scope = nullptr;
-static std::shared_ptr<Scope> impl_scope = nullptr;
-static std::shared_ptr<Scope> top_scope = nullptr;
-static const Type *fn_ret_type = nullptr;
+/// ParLoopFrame - Bookkeeping for a parallel for statement being checked.
+///
+/// Captured mutable variables may only be written through reductions in a
+/// parallel loop, and a reduced variable may not be read anywhere else in it.
+struct ParLoopFrame {
+  ForStmt *loop;
+  std::map<VarDecl *, unsigned int> reads;
+  std::map<VarDecl *, unsigned int> reduces;
+  std::map<VarDecl *, BinaryOp> ops;
+  std::map<VarDecl *, Metadata> array_writes;
+  std::vector<std::pair<VarDecl *, Metadata>> array_reads;
+};
+
+
+/// PendingBounds - An index by the induction variable of a for statement, whose check waits on the loop body.
+struct PendingBounds {
+  IndexExpr *index;
+  bool unconditional;
+  bool overflows;
+};
+
+
+/// LoopFrame - Bookkeeping for a for or until statement being checked.
+///
+/// Bounds checks may only be hoisted in front of a loop, or found to fail at
+/// compile time, for accesses made on every iteration, so the nesting of
+/// conditions is counted and accesses wait until the loop is known not to exit
+/// or skip ahead early.
+struct LoopFrame {
+  ForStmt *loop;
+  unsigned int cond_depth;
+  bool exits;
+  std::vector<PendingBounds> pending;
+};
+
+
+/// AsyncLoopFrame - Bookkeeping for a loop inside an async function.
+///
+/// Locals declared before a loop that awaits and referenced inside of it are
+/// live across the await through the back edge of the loop.
+struct AsyncLoopFrame {
+  unsigned int start;
+  std::vector<NamedDecl *> refs;
+};
+
+
+/// AtomicWrite - A write to an atomic struct field, and the task making it.
+///
+/// Writes in a parallel for statement are made by each of its iterations, and
+/// other writes by the function they are in.
+struct AtomicWrite {
+  StructDecl *parent;
+  FieldDecl *field;
+  const void *task;
+  bool par;
+  Metadata meta;
+};
+
+
+/// SemaState - The bookkeeping of a crate being checked, owned by the visitor checking it.
+///
+/// A visitor keeps its state until it is destroyed, so a crate may be linked
+/// after other crates were checked on the same thread.
+struct SemaState {
+  std::vector<PackageUnit *> pkgs = {};
+  bool has_entry = false;
+  bool in_loop = false;
+  std::shared_ptr<Scope> pkg_scope = nullptr;
+  std::shared_ptr<Scope> impl_scope = nullptr;
+  std::shared_ptr<Scope> top_scope = nullptr;
+  const Type *fn_ret_type = nullptr;
+
+  std::vector<ParLoopFrame> par_frames = {};
+  std::vector<LoopFrame> loop_frames = {};
+  unsigned int cond_depth = 0;
+  bool in_par_loop = false;
+
+  FunctionDecl *curr_fn = nullptr;
+  const Expr *awaited_call = nullptr;
+  const Expr *spawned_call = nullptr;
+
+  /// The argument of a builtin algorithm call which names its predicate, the only place a function is a value.
+  const Expr *predicate_arg = nullptr;
+
+  /// The functions each function calls or references, across all packages of the crate.
+  std::map<FunctionDecl *, std::vector<FunctionDecl *>> call_graph = {};
+
+  unsigned int await_epoch = 0;
+  std::map<NamedDecl *, unsigned int> decl_epochs = {};
+  std::vector<AsyncLoopFrame> async_loops = {};
+
+  std::vector<StructDecl *> laid_out = {};
+  std::vector<StructDecl *> laying_out = {};
+  std::vector<AtomicWrite> atomic_writes = {};
+
+  /// The types built by sema from other types, shared between equal arguments and freed with the visitor.
+  std::map<const Type *, std::unique_ptr<const TaskType>> task_types = {};
+  std::map<const Type *, std::unique_ptr<const RuneType>> rune_types = {};
+  std::map<const Type *, std::unique_ptr<const AtomicType>> atomic_types = {};
+  std::map<std::pair<const Type *, unsigned int>, std::unique_ptr<const ArrayType>> array_types = {};
+  std::map<std::pair<const Type *, unsigned int>, std::unique_ptr<const ChanType>> chan_types = {};
+  std::map<const Type *, std::unique_ptr<const VecType>> vec_types = {};
+  std::map<std::pair<const Type *, const Type *>, std::unique_ptr<const MapType>> map_types = {};
+  std::map<const Type *, std::unique_ptr<const SliceType>> slice_types = {};
+};
+
+/// The state of the visitor checking or linking a crate on this thread.
+static thread_local SemaState *sema = nullptr;
+
+/// SemaScope - Points the helpers of this file at the state of a visitor while it runs, restoring the previous state after.
+class SemaScope final {
+  SemaState *prev;
+
+public:
+  SemaScope(SemaState *state) : prev(sema) { sema = state; }
+  ~SemaScope() { sema = prev; }
+};
+
+
+/// Returns true if a declaration visible from the current scope was declared outside of the given loop.
+static bool is_captured(NamedDecl *d, ForStmt *loop) {
+  for (std::shared_ptr<Scope> s = sema->top_scope; s != nullptr; s = s->get_parent()) {
+    const std::vector<NamedDecl *> decls = s->get_decls();
+    if (std::find(decls.begin(), decls.end(), d) != decls.end()) {
+      return false;
+    }
+
+    if (s == loop->get_scope()) {
+      return true;
+    }
+  }
+  return true;
+}
+
+
+/// Records a call to, or a reference of, a function from the function being checked.
+static void add_call(FunctionDecl *callee) {
+  if (sema->curr_fn) {
+    sema->call_graph[sema->curr_fn].push_back(callee);
+  }
+}
+
+
+/// Returns true if the current function is async.
+static bool in_async_fn(void) {
+  return sema->curr_fn && sema->curr_fn->is_async();
+}
+
+
+/// Enter a loop in an async function.
+static void enter_async_loop(void) {
+  if (in_async_fn()) {
+    sema->async_loops.push_back(AsyncLoopFrame{ sema->await_epoch });
+  }
+}
+
+
+/// Exit a loop in an async function, adding locals that live across its back edge to the frame.
+static void exit_async_loop(void) {
+  if (!in_async_fn()) {
+    return;
+  }
+
+  const AsyncLoopFrame loop = sema->async_loops.back();
+  sema->async_loops.pop_back();
+  if (sema->await_epoch == loop.start) {
+    return;
+  }
+
+  for (NamedDecl *d : loop.refs) {
+    if (sema->decl_epochs.at(d) <= loop.start) {
+      sema->curr_fn->add_frame_decl(d);
+    }
+  }
+}
+
+
+/// Returns the task handle type for a task with the given result type.
+static const TaskType *get_task_type(const Type *T) {
+  std::unique_ptr<const TaskType> &task_t = sema->task_types[T];
+  if (!task_t) {
+    task_t = std::make_unique<TaskType>(T);
+  }
+  return task_t.get();
+}
+
+
+/// Resolves a type reference to the type of the struct or enum it names, or `nullptr` if it is unresolved.
+static const Type *resolve_real_type(const Type *T, std::shared_ptr<Scope> scope) {
+  const TypeRef *RT = dynamic_cast<const TypeRef *>(T);
+  if (!RT) {
+    return T;
+  }
+
+  if (StructDecl *struct_d = dynamic_cast<StructDecl *>(scope->get_decl(RT->get_ident()))) {
+    return struct_d->get_type();
+  } else if (EnumDecl *enum_d = dynamic_cast<EnumDecl *>(scope->get_decl(RT->get_ident()))) {
+    return enum_d->get_type();
+  }
+  return nullptr;
+}
+
+
+/// Returns the rune type pointing to the given type.
+static const RuneType *get_rune_type(const Type *T) {
+  std::unique_ptr<const RuneType> &rune_t = sema->rune_types[T];
+  if (!rune_t) {
+    rune_t = std::make_unique<RuneType>(T);
+  }
+  return rune_t.get();
+}
+
+
+/// Returns the atomic type holding the given type.
+static const AtomicType *get_atomic_type(const Type *T) {
+  std::unique_ptr<const AtomicType> &atomic_t = sema->atomic_types[T];
+  if (!atomic_t) {
+    atomic_t = std::make_unique<AtomicType>(T);
+  }
+  return atomic_t.get();
+}
+
+
+/// Returns the array type with the given element type and length.
+static const ArrayType *get_array_type(const Type *T, unsigned int len) {
+  std::unique_ptr<const ArrayType> &array_t = sema->array_types[{ T, len }];
+  if (!array_t) {
+    array_t = std::make_unique<ArrayType>(len, T);
+  }
+  return array_t.get();
+}
+
+
+/// Returns the channel type with the given element type and capacity.
+static const ChanType *get_chan_type(const Type *T, unsigned int cap) {
+  std::unique_ptr<const ChanType> &chan_t = sema->chan_types[{ T, cap }];
+  if (!chan_t) {
+    chan_t = std::make_unique<ChanType>(cap, T);
+  }
+  return chan_t.get();
+}
+
+
+/// Returns the vector type with the given element type.
+static const VecType *get_vec_type(const Type *T) {
+  std::unique_ptr<const VecType> &vec_t = sema->vec_types[T];
+  if (!vec_t) {
+    vec_t = std::make_unique<VecType>(T);
+  }
+  return vec_t.get();
+}
+
+
+/// Returns the map type with the given key and value types.
+static const MapType *get_map_type(const Type *K, const Type *V) {
+  std::unique_ptr<const MapType> &map_t = sema->map_types[{ K, V }];
+  if (!map_t) {
+    map_t = std::make_unique<MapType>(K, V);
+  }
+  return map_t.get();
+}
+
+
+/// Returns true if values of the given type may be used as map keys. Keys are hashed by their bits, so
+/// floating point values, whose equal values may differ in bits, are excluded.
+static bool is_hashable(const Type *T) {
+  if (const PrimitiveType *pt = dynamic_cast<const PrimitiveType *>(T)) {
+    return !pt->is_float();
+  }
+  return dynamic_cast<const EnumType *>(T);
+}
+
+
+/// Returns the slice type with the given element type.
+static const SliceType *get_slice_type(const Type *T) {
+  std::unique_ptr<const SliceType> &slice_t = sema->slice_types[T];
+  if (!slice_t) {
+    slice_t = std::make_unique<SliceType>(T);
+  }
+  return slice_t.get();
+}
+
+
+/// Returns true if the given type is a builtin type resolved by sema rather than through a type reference, like
+/// task handles, arrays, slices and mapped files. All but mapped files are built from other types.
+static bool is_composite(const Type *T) {
+  return dynamic_cast<const TaskType *>(T) || dynamic_cast<const ArrayType *>(T) || \
+    dynamic_cast<const SliceType *>(T) || dynamic_cast<const RuneType *>(T) || dynamic_cast<const AtomicType *>(T) || \
+    dynamic_cast<const ChanType *>(T) || dynamic_cast<const VecType *>(T) || dynamic_cast<const MapType *>(T) || \
+    dynamic_cast<const MappedFileType *>(T);
+}
+
+
+/// Resolves the element types of a composite type, returning the canonical composite type, or `nullptr` if an
+/// element type is unresolved.
+static const Type *resolve_composite_type(const Type *T, std::shared_ptr<Scope> scope) {
+  // maps are the only composite with two element types
+  if (const MapType *map_t = dynamic_cast<const MapType *>(T)) {
+    const Type *K = resolve_real_type(map_t->get_key_type(), scope);
+    const Type *V = resolve_real_type(map_t->get_value_type(), scope);
+    K = K ? resolve_composite_type(K, scope) : nullptr;
+    V = V ? resolve_composite_type(V, scope) : nullptr;
+    if (!K || !V) {
+      return nullptr;
+    }
+
+    if (!is_hashable(K)) {
+      panic("unhashable map key type: " + K->to_string());
+    }
+    return get_map_type(K, V);
+  }
+
+  const Type *elem = nullptr;
+  if (const TaskType *task_t = dynamic_cast<const TaskType *>(T)) {
+    elem = task_t->get_type();
+  } else if (const ArrayType *arr_t = dynamic_cast<const ArrayType *>(T)) {
+    elem = arr_t->get_type();
+  } else if (const SliceType *slice_t = dynamic_cast<const SliceType *>(T)) {
+    elem = slice_t->get_type();
+  } else if (const RuneType *rune_t = dynamic_cast<const RuneType *>(T)) {
+    elem = rune_t->get_type();
+  } else if (const AtomicType *atomic_t = dynamic_cast<const AtomicType *>(T)) {
+    elem = atomic_t->get_type();
+  } else if (const ChanType *chan_t = dynamic_cast<const ChanType *>(T)) {
+    elem = chan_t->get_type();
+  } else if (const VecType *vec_t = dynamic_cast<const VecType *>(T)) {
+    elem = vec_t->get_type();
+  }
+
+  if (!elem) {
+    return T;
+  }
+
+  elem = resolve_real_type(elem, scope);
+  if (!elem) {
+    return nullptr;
+  }
+  elem = resolve_composite_type(elem, scope);
+  if (!elem) {
+    return nullptr;
+  }
+
+  if (dynamic_cast<const TaskType *>(T)) {
+    return get_task_type(elem);
+  } else if (const ArrayType *arr_t = dynamic_cast<const ArrayType *>(T)) {
+    return get_array_type(elem, arr_t->get_len());
+  } else if (dynamic_cast<const RuneType *>(T)) {
+    return get_rune_type(elem);
+  } else if (dynamic_cast<const AtomicType *>(T)) {
+    return get_atomic_type(elem);
+  } else if (const ChanType *chan_t = dynamic_cast<const ChanType *>(T)) {
+    return get_chan_type(elem, chan_t->get_cap());
+  } else if (dynamic_cast<const VecType *>(T)) {
+    return get_vec_type(elem);
+  }
+  return get_slice_type(elem);
+}
+
+
+static bool types_match(const Type *expected, const Type *actual);
+
+/// Returns true if two payload types are the same, with built-in types compared by kind rather than by
+/// whether one converts to the other.
+static bool payloads_match(const Type *expected, const Type *actual) {
+  const PrimitiveType *pt_exp = dynamic_cast<const PrimitiveType *>(expected);
+  const PrimitiveType *pt_act = dynamic_cast<const PrimitiveType *>(actual);
+  if (pt_exp || pt_act) {
+    return pt_exp && pt_act && pt_exp->get_kind() == pt_act->get_kind();
+  }
+  return types_match(expected, actual);
+}
+
+
+/// Returns true if a value of type `actual` may be used where type `expected` is required.
+static bool types_match(const Type *expected, const Type *actual) {
+  if (!expected || !actual) {
+    return expected == actual;
+  }
+
+  // there is a single mapped file type
+  if (dynamic_cast<const MappedFileType *>(expected) || dynamic_cast<const MappedFileType *>(actual)) {
+    return dynamic_cast<const MappedFileType *>(expected) && dynamic_cast<const MappedFileType *>(actual);
+  }
+
+  // vectors only match vectors of the same shape
+  if (dynamic_cast<const VectorType *>(expected) || dynamic_cast<const VectorType *>(actual)) {
+    return expected == actual;
+  }
+
+  if (expected->is_builtin()) {
+    const PrimitiveType *pt = dynamic_cast<const PrimitiveType *>(expected);
+    return pt && pt->compare(actual);
+  }
+
+  // task handles are compared by their result types, and runes by the types they point to, which must be
+  // exactly the same since the payload is not converted
+  const TaskType *task_exp = dynamic_cast<const TaskType *>(expected);
+  const TaskType *task_act = dynamic_cast<const TaskType *>(actual);
+  if (task_exp && task_act) {
+    return payloads_match(resolve_real_type(task_exp->get_type(), sema->pkg_scope),
+                          resolve_real_type(task_act->get_type(), sema->pkg_scope));
+  }
+
+  const RuneType *rune_exp = dynamic_cast<const RuneType *>(expected);
+  const RuneType *rune_act = dynamic_cast<const RuneType *>(actual);
+  if (rune_exp && rune_act) {
+    return payloads_match(resolve_real_type(rune_exp->get_type(), sema->pkg_scope),
+                          resolve_real_type(rune_act->get_type(), sema->pkg_scope));
+  }
+
+  // arrays are compared by their element types and lengths, and arrays and vectors may be borrowed as slices
+  const ArrayType *arr_act = dynamic_cast<const ArrayType *>(actual);
+  const SliceType *slice_act = dynamic_cast<const SliceType *>(actual);
+  const VecType *vec_act = dynamic_cast<const VecType *>(actual);
+  const Type *elem_act = arr_act ? arr_act->get_type() : slice_act ? slice_act->get_type() : \
+    vec_act ? vec_act->get_type() : nullptr;
+  if (const ArrayType *arr_exp = dynamic_cast<const ArrayType *>(expected)) {
+    return arr_act && arr_exp->get_len() == arr_act->get_len() && \
+      types_match(resolve_real_type(arr_exp->get_type(), sema->pkg_scope), resolve_real_type(elem_act, sema->pkg_scope));
+  } else if (const SliceType *slice_exp = dynamic_cast<const SliceType *>(expected)) {
+    return elem_act && \
+      types_match(resolve_real_type(slice_exp->get_type(), sema->pkg_scope), resolve_real_type(elem_act, sema->pkg_scope));
+  }
+
+  // vectors are constructed from arrays, and maps from map literals, whose elements are converted
+  if (const VecType *vec_exp = dynamic_cast<const VecType *>(expected)) {
+    return (arr_act || vec_act) && \
+      types_match(resolve_real_type(vec_exp->get_type(), sema->pkg_scope), resolve_real_type(elem_act, sema->pkg_scope));
+  }
+
+  const MapType *map_exp = dynamic_cast<const MapType *>(expected);
+  const MapType *map_act = dynamic_cast<const MapType *>(actual);
+  if (map_exp && map_act) {
+    return types_match(resolve_real_type(map_exp->get_key_type(), sema->pkg_scope), \
+        resolve_real_type(map_act->get_key_type(), sema->pkg_scope)) && \
+      types_match(resolve_real_type(map_exp->get_value_type(), sema->pkg_scope), \
+        resolve_real_type(map_act->get_value_type(), sema->pkg_scope));
+  }
+  return expected == actual;
+}
+
+
+/// Returns true if two resolved types are the same type. Structs and enums are compared by identity, since packages
+/// may declare types of the same name, while primitive types, of which each package has its own, are compared by kind.
+static bool same_type(const Type *A, const Type *B) {
+  if (A == B) {
+    return true;
+  } else if (!A || !B) {
+    return false;
+  }
+
+  const PrimitiveType *pt_a = dynamic_cast<const PrimitiveType *>(A);
+  const PrimitiveType *pt_b = dynamic_cast<const PrimitiveType *>(B);
+  if (pt_a || pt_b) {
+    return pt_a && pt_b && pt_a->get_kind() == pt_b->get_kind();
+  }
+
+  // canonical composite types differ when their primitive element types come from different packages
+  if (const ArrayType *arr_a = dynamic_cast<const ArrayType *>(A)) {
+    const ArrayType *arr_b = dynamic_cast<const ArrayType *>(B);
+    return arr_b && arr_a->get_len() == arr_b->get_len() && same_type(arr_a->get_type(), arr_b->get_type());
+  } else if (const SliceType *slice_a = dynamic_cast<const SliceType *>(A)) {
+    const SliceType *slice_b = dynamic_cast<const SliceType *>(B);
+    return slice_b && same_type(slice_a->get_type(), slice_b->get_type());
+  } else if (const VecType *vec_a = dynamic_cast<const VecType *>(A)) {
+    const VecType *vec_b = dynamic_cast<const VecType *>(B);
+    return vec_b && same_type(vec_a->get_type(), vec_b->get_type());
+  } else if (const TaskType *task_a = dynamic_cast<const TaskType *>(A)) {
+    const TaskType *task_b = dynamic_cast<const TaskType *>(B);
+    return task_b && same_type(task_a->get_type(), task_b->get_type());
+  } else if (const RuneType *rune_a = dynamic_cast<const RuneType *>(A)) {
+    const RuneType *rune_b = dynamic_cast<const RuneType *>(B);
+    return rune_b && same_type(rune_a->get_type(), rune_b->get_type());
+  } else if (const AtomicType *atomic_a = dynamic_cast<const AtomicType *>(A)) {
+    const AtomicType *atomic_b = dynamic_cast<const AtomicType *>(B);
+    return atomic_b && same_type(atomic_a->get_type(), atomic_b->get_type());
+  } else if (const ChanType *chan_a = dynamic_cast<const ChanType *>(A)) {
+    const ChanType *chan_b = dynamic_cast<const ChanType *>(B);
+    return chan_b && chan_a->get_cap() == chan_b->get_cap() && same_type(chan_a->get_type(), chan_b->get_type());
+  } else if (const MapType *map_a = dynamic_cast<const MapType *>(A)) {
+    const MapType *map_b = dynamic_cast<const MapType *>(B);
+    return map_b && same_type(map_a->get_key_type(), map_b->get_key_type()) && \
+      same_type(map_a->get_value_type(), map_b->get_value_type());
+  }
+  return dynamic_cast<const MappedFileType *>(A) && dynamic_cast<const MappedFileType *>(B);
+}
+
+
+static const PrimitiveType *bool_type = new PrimitiveType(PrimitiveType::__UINT1);
+static const PrimitiveType *u8_type = new PrimitiveType(PrimitiveType::__UINT8);
+static const PrimitiveType *i32_type = new PrimitiveType(PrimitiveType::__INT32);
+static const PrimitiveType *u64_type = new PrimitiveType(PrimitiveType::__UINT64);
+static const PrimitiveType *str_type = new PrimitiveType(PrimitiveType::__STR);
+static const MappedFileType *mapped_file_type = new MappedFileType();
+
+/// Returns the element type of an array, slice, vector or string type, or `nullptr` if the type cannot be indexed.
+static const Type *get_element_type(const Type *T) {
+  if (const ArrayType *arr_t = dynamic_cast<const ArrayType *>(T)) {
+    return resolve_real_type(arr_t->get_type(), sema->pkg_scope);
+  } else if (const SliceType *slice_t = dynamic_cast<const SliceType *>(T)) {
+    return resolve_real_type(slice_t->get_type(), sema->pkg_scope);
+  } else if (const VecType *vec_t = dynamic_cast<const VecType *>(T)) {
+    return resolve_real_type(vec_t->get_type(), sema->pkg_scope);
+  } else if (T && T->is_str()) {
+    return u8_type;
+  }
+  return nullptr;
+}
+
+
+/// Returns true if the given type is a struct stored field by field in arrays and vectors.
+static bool is_soa(const Type *T) {
+  const StructType *st = dynamic_cast<const StructType *>(T);
+  StructDecl *struct_d = st ? dynamic_cast<StructDecl *>(sema->pkg_scope->get_decl(st->get_name())) : nullptr;
+  return struct_d && struct_d->is_soa();
+}
+
+
+/// TypeLayout - The size and alignment of a type, in bytes.
+struct TypeLayout {
+  unsigned long size;
+  unsigned int align;
+};
+
+
+static void layout_struct(StructDecl *d);
+
+/// Returns the size and alignment of a type.
+static TypeLayout get_layout(const Type *T) {
+  if (const PrimitiveType *pt = dynamic_cast<const PrimitiveType *>(T)) {
+    const unsigned int size = pt->is_str() ? StrLayout::size : std::max(pt->get_bits() / 8, 1u);
+    return { size, pt->is_str() ? 8 : size };
+  } else if (const VectorType *vt = dynamic_cast<const VectorType *>(T)) {
+    return { vt->get_bits() / 8, vt->get_bits() / 8 };
+  } else if (const ArrayType *at = dynamic_cast<const ArrayType *>(T)) {
+    const TypeLayout elem = get_layout(at->get_type());
+    return { elem.size * at->get_len(), elem.align };
+  } else if (const AtomicType *at = dynamic_cast<const AtomicType *>(T)) {
+    const TypeLayout elem = get_layout(at->get_type());
+    return { elem.size, static_cast<unsigned int>(elem.size) };
+  } else if (dynamic_cast<const SliceType *>(T)) {
+    return { SliceLayout::size, 8 };
+  } else if (dynamic_cast<const ChanType *>(T)) {
+    return { ChanLayout::size, 8 };
+  } else if (dynamic_cast<const VecType *>(T)) {
+    return { VecLayout::size, 8 };
+  } else if (dynamic_cast<const MapType *>(T)) {
+    return { MapLayout::size, 8 };
+  } else if (dynamic_cast<const MappedFileType *>(T)) {
+    return { MappedFileLayout::size, 8 };
+  } else if (dynamic_cast<const EnumType *>(T)) {
+    return { 4, 4 };
+  }
+
+  // struct fields may still refer to structs which have not been checked yet
+  std::string name;
+  if (const StructType *st = dynamic_cast<const StructType *>(T)) {
+    name = st->get_name();
+  } else if (const TypeRef *ref = dynamic_cast<const TypeRef *>(T)) {
+    name = ref->get_ident();
+  }
+
+  if (StructDecl *struct_d = name.empty() ? nullptr : dynamic_cast<StructDecl *>(sema->pkg_scope->get_decl(name))) {
+    layout_struct(struct_d);
+    return { struct_d->get_size(), struct_d->get_align() };
+  }
+
+  // tasks and runes are pointers
+  return { 8, 8 };
+}
+
+
+/// Computes the offsets of the fields of a struct, and its size and alignment.
+///
+/// Each field is placed at the next offset aligned to the larger of its natural
+/// alignment and its `#[align(N)]` attribute. A `#[cache_padded]` field starts a
+/// cache line, and the field after it starts the next one.
+static void layout_struct(StructDecl *d) {
+  if (std::find(sema->laid_out.begin(), sema->laid_out.end(), d) != sema->laid_out.end()) {
+    return;
+  } else if (std::find(sema->laying_out.begin(), sema->laying_out.end(), d) != sema->laying_out.end()) {
+    panic("recursive struct: " + d->get_name(), d->get_meta());
+  }
+  sema->laying_out.push_back(d);
+
+  unsigned long offset = 0;
+  unsigned int align = std::max(d->get_align(), 1u);
+  for (FieldDecl *field : d->get_fields()) {
+    const TypeLayout field_layout = get_layout(field->get_type());
+    unsigned int field_align = std::max(field_layout.align, field->get_align());
+    if (field->is_cache_padded()) {
+      field_align = std::max(field_align, StructLayout::cache_line);
+    }
+
+    offset = StructLayout::align_to(offset, field_align);
+    field->set_offset(offset);
+    offset += field_layout.size;
+    if (field->is_cache_padded()) {
+      offset = StructLayout::align_to(offset, StructLayout::cache_line);
+    }
+    align = std::max(align, field_align);
+  }
+
+  d->set_align(align);
+  d->set_size(StructLayout::align_to(offset, align));
+  sema->laying_out.pop_back();
+  sema->laid_out.push_back(d);
+}
+
+
+/// Records a write to an atomic, if it is a struct field.
+static void add_atomic_write(MemberCallExpr *e) {
+  MemberExpr *member = dynamic_cast<MemberExpr *>(e->get_base());
+  const StructType *st = member ? dynamic_cast<const StructType *>(member->get_base()->get_type()) : nullptr;
+  StructDecl *struct_d = st ? dynamic_cast<StructDecl *>(sema->pkg_scope->get_decl(st->get_name())) : nullptr;
+  if (!struct_d) {
+    return;
+  }
+
+  const void *task = sema->in_par_loop ? static_cast<const void *>(sema->par_frames.back().loop) : sema->curr_fn;
+  sema->atomic_writes.push_back({ struct_d, struct_d->get_field(member->get_member()), task, sema->in_par_loop, e->get_meta() });
+}
+
+
+/// Warns about atomic struct fields which are written by different tasks and share a cache line.
+///
+/// Each write to one of them takes the line away from the other writers, even
+/// though they touch different fields. Such fields should be `#[cache_padded]`.
+static void lint_false_sharing(void) {
+  std::vector<std::pair<FieldDecl *, FieldDecl *>> warned = {};
+  for (const AtomicWrite &a : sema->atomic_writes) {
+    for (const AtomicWrite &b : sema->atomic_writes) {
+      if (a.parent != b.parent || a.field->get_offset() >= b.field->get_offset() || (a.task == b.task && !a.par)) {
+        continue;
+      }
+
+      // the last line of the first field is the first line of the second
+      const unsigned long a_end = a.field->get_offset() + get_layout(a.field->get_type()).size - 1;
+      if (a_end / StructLayout::cache_line != b.field->get_offset() / StructLayout::cache_line) {
+        continue;
+      }
+
+      if (std::find(warned.begin(), warned.end(), std::make_pair(a.field, b.field)) != warned.end()) {
+        continue;
+      }
+      warned.push_back({ a.field, b.field });
+      warn("atomics written by different tasks share a cache line: " + a.parent->get_name() + "." + \
+        a.field->get_name() + " and " + a.parent->get_name() + "." + b.field->get_name(), b.meta);
+    }
+  }
+}
+
+
+/// Returns how the bounds of an index expression need to be checked.
+///
+/// Constant indices into arrays are checked at compile time. Indexing by the
+/// induction variable of an enclosing for statement is not checked at all if
+/// the range is constant and inside an array. Otherwise it is checked once,
+/// against the range of the loop, in front of it, if the access is made on every
+/// iteration, and constant ranges past the end of an array are rejected; which is
+/// decided once the loop is checked, see `finish_bounds`. Slices and strings which
+/// may be reassigned in the loop are still checked on every access.
+static BoundsCheck check_bounds(IndexExpr *e) {
+  const ArrayType *arr_t = dynamic_cast<const ArrayType *>(e->get_base()->get_type());
+  if (IntegerLiteral *lit = dynamic_cast<IntegerLiteral *>(e->get_index())) {
+    if (!arr_t) {
+      return BoundsChecked;
+    }
+
+    if (lit->is_signed() || lit->get_value() < 0 || lit->get_value() >= arr_t->get_len()) {
+      panic("index out of bounds: " + std::to_string(lit->get_value()), e->get_meta());
+    }
+    return BoundsElided;
+  }
+
+  DeclRefExpr *base = dynamic_cast<DeclRefExpr *>(e->get_base());
+  DeclRefExpr *index = dynamic_cast<DeclRefExpr *>(e->get_index());
+  if (!base || !index) {
+    return BoundsChecked;
+  }
+
+  NamedDecl *base_d = sema->top_scope->get_decl(base->get_ident());
+  Decl *index_d = sema->top_scope->get_decl(index->get_ident());
+  for (auto it = sema->loop_frames.rbegin(); it != sema->loop_frames.rend(); it++) {
+    ForStmt *loop = it->loop;
+    if (!loop || loop->get_var() != index_d) {
+      continue;
+    }
+
+    // the base must exist in front of the loop, and keep its length through it
+    VarDecl *base_vd = dynamic_cast<VarDecl *>(base_d);
+    if (!base_d || !is_captured(base_d, loop) || (!arr_t && base_vd && base_vd->is_mut())) {
+      return BoundsChecked;
+    }
+
+    IntegerLiteral *lo = dynamic_cast<IntegerLiteral *>(loop->get_lo());
+    IntegerLiteral *hi = dynamic_cast<IntegerLiteral *>(loop->get_hi());
+    if (arr_t && lo && hi && lo->get_value() >= 0 && hi->get_value() >= 0 && hi->get_value() <= arr_t->get_len()) {
+      return BoundsElided;
+    }
+
+    const bool overflows = arr_t && lo && hi && lo->get_value() < hi->get_value() && \
+      (lo->get_value() < 0 || hi->get_value() > arr_t->get_len());
+    it->pending.push_back({ e, sema->cond_depth == it->cond_depth, overflows });
+    return BoundsChecked;
+  }
+  return BoundsChecked;
+}
+
+
+/// Decides the bounds checks of the accesses of a loop by its induction variable, once its body is checked.
+static void finish_bounds(const LoopFrame &frame) {
+  for (const PendingBounds &p : frame.pending) {
+    // accesses which may be skipped are checked where they happen, so a check in front of the loop cannot
+    // fail a program which never goes out of bounds
+    const bool every_iteration = p.unconditional && !frame.exits;
+    if (p.overflows && every_iteration) {
+      const ArrayType *arr_t = static_cast<const ArrayType *>(p.index->get_base()->get_type());
+      panic("loop range exceeds array of length " + std::to_string(arr_t->get_len()), p.index->get_meta());
+    } else if (!p.overflows && every_iteration) {
+      frame.loop->add_hoisted(static_cast<DeclRefExpr *>(p.index->get_base())->get_ident());
+      p.index->set_bounds(BoundsHoisted);
+    }
+  }
+}
+
+/// Returns true if the value of an integer literal fits in the given integer type.
+static bool literal_fits(IntegerLiteral *lit, const PrimitiveType *pt) {
+  const long long value = lit->get_value();
+  const unsigned int bits = pt->get_bits();
+
+  // values above the range of i64 are wrapped, and only fit in a u64
+  if (value < 0 && !lit->is_signed()) {
+    return !pt->is_signed() && bits == 64;
+  }
+
+  if (!pt->is_signed()) {
+    return value >= 0 && (bits == 64 || value <= static_cast<long long>((1ULL << bits) - 1));
+  }
+  return bits == 64 || (value >= -(1LL << (bits - 1)) && value <= (1LL << (bits - 1)) - 1);
+}
+
+
+/// Returns true if the type of an expression is not fixed yet, and adapts to the type it is used as.
+static bool is_adaptable(Expr *e) {
+  if (IntegerLiteral *lit = dynamic_cast<IntegerLiteral *>(e)) {
+    return !lit->is_suffixed();
+  } else if (FPLiteral *lit = dynamic_cast<FPLiteral *>(e)) {
+    return !lit->is_suffixed();
+  } else if (BinaryExpr *bin = dynamic_cast<BinaryExpr *>(e)) {
+    return !is_comparison_op(bin->get_op()) && !is_assignment_op(bin->get_op()) && \
+      is_adaptable(bin->get_lhs()) && is_adaptable(bin->get_rhs());
+  }
+  return false;
+}
+
+
+/// Checks that an expression may be implicitly converted to the expected type.
+///
+/// Adaptable expressions take on the expected type, so long as literal values
+/// fit in it. Other integer and floating point values may only widen, and
+/// narrowing them, changing their sign, or converting between integers and
+/// booleans requires an explicit `as` cast.
+static void check_conversion(const Type *expected, Expr *e) {
+  // map literals convert entry-wise, and other maps must be of the same type
+  if (const MapType *map_t = dynamic_cast<const MapType *>(expected)) {
+    if (MapExpr *map = dynamic_cast<MapExpr *>(e)) {
+      for (std::size_t i = 0; i < map->get_num_entries(); i++) {
+        check_conversion(resolve_real_type(map_t->get_key_type(), sema->pkg_scope), map->get_key(i));
+        check_conversion(resolve_real_type(map_t->get_value_type(), sema->pkg_scope), map->get_value(i));
+      }
+      map->set_type(expected);
+    } else if (expected != e->get_type()) {
+      panic("type mismatch between " + expected->to_string() + " and " + e->get_type()->to_string(), e->get_meta());
+    }
+    return;
+  }
+
+  // array literals convert element-wise, and other arrays, slices and vectors must match their element types exactly
+  if (dynamic_cast<const ArrayType *>(expected) || dynamic_cast<const SliceType *>(expected) || \
+      dynamic_cast<const VecType *>(expected)) {
+    const Type *elem = get_element_type(expected);
+
+    if (ArrayExpr *arr = dynamic_cast<ArrayExpr *>(e)) {
+      for (std::size_t i = 0; i < arr->get_num_elements(); i++) {
+        check_conversion(elem, arr->get_element(i));
+      }
+      arr->set_type(get_array_type(elem, arr->get_num_elements()));
+      return;
+    }
+
+    const Type *actual = resolve_composite_type(e->get_type(), sema->pkg_scope);
+    const Type *elem_act = get_element_type(actual);
+    if (dynamic_cast<const SliceType *>(expected) && !dynamic_cast<const SliceType *>(actual) && is_soa(elem_act)) {
+      panic("slice of struct-of-arrays storage: " + actual->to_string(), e->get_meta());
+    }
+    if (!same_type(elem, elem_act)) {
+      panic("type mismatch between " + expected->to_string() + " and " + actual->to_string(), e->get_meta());
+    }
+    return;
+  }
+
+  const PrimitiveType *to = dynamic_cast<const PrimitiveType *>(expected);
+  const PrimitiveType *from = dynamic_cast<const PrimitiveType *>(e->get_type());
+  if (!to || !from) {
+    return;
+  } else if (to->is_bool() || from->is_bool()) {
+    if (to->is_bool() != from->is_bool() && to->is_integer() && from->is_integer()) {
+      panic("implicit conversion from " + from->to_string() + " to " + to->to_string() + \
+        (to->is_bool() ? ", compare against zero instead" : ", use 'as'"), e->get_meta());
+    }
+    return;
+  }
+
+  if (!(to->is_integer() && from->is_integer()) && !(to->is_float() && from->is_float())) {
+    return;
+  }
+
+  if (is_adaptable(e)) {
+    if (IntegerLiteral *lit = dynamic_cast<IntegerLiteral *>(e)) {
+      if (!literal_fits(lit, to)) {
+        panic("integer literal out of range for type " + to->to_string(), e->get_meta());
+      }
+      lit->set_type(to);
+    } else if (FPLiteral *lit = dynamic_cast<FPLiteral *>(e)) {
+      lit->set_type(to);
+    } else if (BinaryExpr *bin = dynamic_cast<BinaryExpr *>(e)) {
+      check_conversion(to, bin->get_lhs());
+      check_conversion(to, bin->get_rhs());
+      bin->set_type(to);
+    }
+    return;
+  }
+
+  if (from->get_bits() > to->get_bits()) {
+    panic("implicit narrowing conversion from " + from->to_string() + " to " + to->to_string() + \
+      ", use 'as'", e->get_meta());
+  } else if (to->is_integer() && from->is_signed() != to->is_signed()) {
+    panic("implicit sign conversion from " + from->to_string() + " to " + to->to_string() + \
+      ", use 'as'", e->get_meta());
+  }
+}
+
+/// Checks a binary expression with a vector operand, and returns its lane-wise result type. Scalar
+/// operands are splat across all lanes of the vector operand.
+static const Type *check_vector_binary(BinaryExpr *e) {
+  const Type *lhs = e->get_lhs()->get_type();
+  const Type *rhs = e->get_rhs()->get_type();
+  const VectorType *vt = dynamic_cast<const VectorType *>(lhs);
+  if (!vt) {
+    vt = dynamic_cast<const VectorType *>(rhs);
+  }
+
+  const Type *other = vt == lhs ? rhs : lhs;
+  if (other != vt) {
+    if (vt->is_mask() || !vt->get_elem()->compare(other)) {
+      panic("vector type mismatch in binary expression", e->get_meta());
+    }
+    check_conversion(vt->get_elem(), vt == lhs ? e->get_rhs() : e->get_lhs());
+  }
+
+  if (is_assignment_op(e->get_op()) && lhs != vt) {
+    panic("assignment of vector to scalar", e->get_meta());
+  }
+
+  switch (e->get_op()) {
+    case BinaryOp::LogicAnd:
+    case BinaryOp::LogicOr:
+      if (!vt->is_mask()) {
+        panic("logical operator on non-mask vector", e->get_meta());
+      }
+      return vt;
+    case BinaryOp::IsEq:
+    case BinaryOp::IsNotEq:
+    case BinaryOp::Lt:
+    case BinaryOp::LtEquals:
+    case BinaryOp::Gt:
+    case BinaryOp::GtEquals:
+      if (vt->is_mask()) {
+        panic("comparison of mask vectors", e->get_meta());
+      }
+      return vt->get_mask_type();
+    case BinaryOp::Assign:
+      return vt;
+    default:
+      if (vt->is_mask()) {
+        panic("arithmetic on mask vector", e->get_meta());
+      }
+      return vt;
+  }
+}
+
+
+/// Checks a builtin method call on a vector, and returns its result type.
+///
+/// Vectors support the horizontal reductions `sum`, `min` and `max`, and `shuffle` with a constant
+/// lane index for each lane. Masks support `any`, `all` and `select` between two vectors of a shape
+/// which produces them.
+static const Type *check_vector_method(MemberCallExpr *e, const VectorType *vt) {
+  const std::string method = e->get_callee();
+  if (vt->is_mask() && (method == "any" || method == "all")) {
+    if (e->get_num_args() != 0) {
+      panic("function " + method + " has 0 parameters but " + std::to_string(e->get_num_args()) + " were provided.", e->get_meta());
+    }
+    return bool_type;
+  } else if (vt->is_mask() && method == "select") {
+    if (e->get_num_args() != 2) {
+      panic("function select has 2 parameters but " + std::to_string(e->get_num_args()) + " were provided.", e->get_meta());
+    }
+
+    // both vectors must share a shape whose comparisons produce this mask
+    const VectorType *value_t = dynamic_cast<const VectorType *>(e->get_arg(0)->get_type());
+    if (!value_t || value_t->get_mask_type() != vt || e->get_arg(1)->get_type() != value_t) {
+      panic("type mismatch in vector select", e->get_meta());
+    }
+    return value_t;
+  } else if (!vt->is_mask() && (method == "sum" || method == "min" || method == "max")) {
+    if (e->get_num_args() != 0) {
+      panic("function " + method + " has 0 parameters but " + std::to_string(e->get_num_args()) + " were provided.", e->get_meta());
+    }
+    return vt->get_elem();
+  } else if (!vt->is_mask() && method == "shuffle") {
+    if (e->get_num_args() != vt->get_lanes()) {
+      panic("function shuffle has " + std::to_string(vt->get_lanes()) + " parameters but " + \
+      std::to_string(e->get_num_args()) + " were provided.", e->get_meta());
+    }
+
+    // shuffles are lowered to a single permute, so lane indices must be constant
+    for (int i = 0; i < e->get_num_args(); i++) {
+      IntegerLiteral *idx = dynamic_cast<IntegerLiteral *>(e->get_arg(i));
+      if (!idx) {
+        panic("expected constant lane index in vector shuffle", e->get_arg(i)->get_meta());
+      }
+
+      if (idx->get_value() < 0 || idx->get_value() >= vt->get_lanes()) {
+        panic("lane index out of range in vector shuffle: " + std::to_string(idx->get_value()), idx->get_meta());
+      }
+    }
+    return vt;
+  }
+  panic("unresolved method on vector " + vt->to_string() + ": " + method, e->get_meta());
+  return nullptr;
+}
+
+
+/// The variants of the builtin enums, which name memory orderings and file access hints.
+static const std::map<std::string, std::vector<std::string>> BUILTIN_ENUMS = {
+  { "Ordering", { "Relaxed", "Acquire", "Release", "AcqRel", "SeqCst" } },
+  { "Advice", { "Normal", "Sequential", "Random", "WillNeed" } },
+};
+
+/// Returns the variant of the given builtin enum named by an argument of a builtin method. Variants must be
+/// constant, as each one selects a different instruction sequence or system call.
+static std::string get_builtin_variant(const Expr *e, const std::string &enum_name) {
+  const DeclRefExpr *ref = dynamic_cast<const DeclRefExpr *>(e);
+  const EnumType *et = ref ? dynamic_cast<const EnumType *>(ref->get_type()) : nullptr;
+  if (!ref || !ref->is_nested() || !et || et->get_name() != enum_name) {
+    panic("expected constant " + enum_name + " variant", e->get_meta());
+  }
+  return ref->get_ident();
+}
+
+
+/// Returns the memory ordering named by an argument of an atomic method.
+static std::string get_ordering(const Expr *e) {
+  return get_builtin_variant(e, "Ordering");
+}
+
+
+/// Checks a builtin method call on an atomic, and returns its result type.
+///
+/// Atomics support `load`, `store`, `swap`, `compare_exchange` and, when they hold an integer, `fetch_add`.
+/// Loads may not release, stores may not acquire, and the failure ordering of `compare_exchange` is a load.
+static const Type *check_atomic_method(MemberCallExpr *e, const AtomicType *at) {
+  const std::string method = e->get_callee();
+  const Type *T = at->get_type();
+
+  int n_values = 0;
+  if (method == "load") {
+    n_values = 0;
+  } else if (method == "store" || method == "swap" || method == "fetch_add") {
+    n_values = 1;
+  } else if (method == "compare_exchange") {
+    n_values = 2;
+  } else {
+    panic("unresolved method on " + at->to_string() + ": " + method, e->get_meta());
+  }
+
+  const int n_orderings = method == "compare_exchange" ? 2 : 1;
+  if (e->get_num_args() != n_values + n_orderings) {
+    panic("function " + method + " has " + std::to_string(n_values + n_orderings) + " parameters but " + \
+    std::to_string(e->get_num_args()) + " were provided.", e->get_meta());
+  }
+
+  for (int i = 0; i < n_values; i++) {
+    if (!types_match(T, e->get_arg(i)->get_type())) {
+      panic("type mismatch in atomic " + method, e->get_arg(i)->get_meta());
+    }
+    check_conversion(T, e->get_arg(i));
+  }
+
+  const std::string ord = get_ordering(e->get_arg(n_values));
+  const std::string fail_ord = n_orderings == 2 ? get_ordering(e->get_arg(n_values + 1)) : "";
+  if ((method == "load" && (ord == "Release" || ord == "AcqRel")) || \
+      (!fail_ord.empty() && (fail_ord == "Release" || fail_ord == "AcqRel"))) {
+    panic("invalid memory ordering for atomic load: " + (fail_ord.empty() ? ord : fail_ord), e->get_meta());
+  } else if (method == "store" && (ord == "Acquire" || ord == "AcqRel")) {
+    panic("invalid memory ordering for atomic store: " + ord, e->get_meta());
+  }
+
+  if (method == "fetch_add") {
+    const PrimitiveType *pt = dynamic_cast<const PrimitiveType *>(T);
+    if (!pt || pt->is_bool()) {
+      panic("fetch_add on non-integer atomic: " + at->to_string(), e->get_meta());
+    }
+  }
+
+  if (method == "store") {
+    return nullptr;
+  } else if (method == "compare_exchange") {
+    return bool_type;
+  }
+  return T;
+}
+
+
+/// Checks a builtin method call on a channel, and returns its result type.
+///
+/// Channels support blocking `send` and `recv`, a non-blocking `try_send`, and `send_batch` and `recv_batch`,
+/// which move a run of values with a single claim on the ring. `recv_batch` fills a mutable array with at least
+/// one value, and returns how many it received.
+static const Type *check_chan_method(MemberCallExpr *e, const ChanType *ct) {
+  const std::string method = e->get_callee();
+  const Type *T = resolve_real_type(ct->get_type(), sema->pkg_scope);
+
+  const int n_args = method == "recv" ? 0 : 1;
+  if (method != "send" && method != "recv" && method != "try_send" && method != "send_batch" && method != "recv_batch") {
+    panic("unresolved method on " + ct->to_string() + ": " + method, e->get_meta());
+  } else if (e->get_num_args() != n_args) {
+    panic("function " + method + " has " + std::to_string(n_args) + " parameters but " + \
+    std::to_string(e->get_num_args()) + " were provided.", e->get_meta());
+  }
+
+  if (method == "send" || method == "try_send") {
+    if (!types_match(T, e->get_arg(0)->get_type())) {
+      panic("type mismatch in channel " + method, e->get_arg(0)->get_meta());
+    }
+    check_conversion(T, e->get_arg(0));
+    return method == "send" ? nullptr : bool_type;
+  } else if (method == "send_batch") {
+    if (!types_match(get_slice_type(T), e->get_arg(0)->get_type())) {
+      panic("type mismatch in channel send_batch", e->get_arg(0)->get_meta());
+    }
+    check_conversion(get_slice_type(T), e->get_arg(0));
+    return nullptr;
+  } else if (method == "recv_batch") {
+    // received values are written into the buffer, so it must be a mutable array owned by this thread
+    DeclRefExpr *buf = dynamic_cast<DeclRefExpr *>(e->get_arg(0));
+    VarDecl *vd = buf ? dynamic_cast<VarDecl *>(sema->top_scope->get_decl(buf->get_ident())) : nullptr;
+    const ArrayType *arr_t = vd ? dynamic_cast<const ArrayType *>(vd->get_type()) : nullptr;
+    if (!arr_t || !vd->is_mut()) {
+      panic("channel recv_batch into non-mutable-array", e->get_arg(0)->get_meta());
+    }
+
+    if (arr_t->get_type()->to_string() != T->to_string()) {
+      panic("type mismatch in channel recv_batch", e->get_arg(0)->get_meta());
+    }
+
+    for (ParLoopFrame &frame : sema->par_frames) {
+      if (is_captured(vd, frame.loop)) {
+        panic("data race on captured variable in parallel loop: " + vd->get_name(), e->get_arg(0)->get_meta());
+      }
+    }
+    return u64_type;
+  }
+  return T;
+}
+
+
+/// Checks that the receiver of a mutating builtin method is a mutable variable, or a field of one, which is
+/// not captured by an enclosing parallel loop.
+static void check_mut_receiver(MemberCallExpr *e) {
+  Expr *base = e->get_base();
+  while (MemberExpr *member = dynamic_cast<MemberExpr *>(base)) {
+    base = member->get_base();
+  }
+
+  DeclRefExpr *d = dynamic_cast<DeclRefExpr *>(base);
+  VarDecl *vd = d ? dynamic_cast<VarDecl *>(sema->top_scope->get_decl(d->get_ident())) : nullptr;
+  if (!vd || !vd->is_mut()) {
+    panic("attempted to mutate immutable variable through " + e->get_callee(), e->get_meta());
+  }
+
+  for (ParLoopFrame &frame : sema->par_frames) {
+    if (is_captured(vd, frame.loop)) {
+      panic("data race on captured variable in parallel loop: " + vd->get_name(), e->get_meta());
+    }
+  }
+}
+
+
+/// Checks that a slice kept in a variable does not borrow a mutable vector, whose storage moves when it grows.
+/// Slices passed as arguments to calls which are not spawned only live for the call, so they may borrow any vector.
+static void check_vec_borrow(const Type *expected, Expr *e) {
+  if (!dynamic_cast<const SliceType *>(expected)) {
+    return;
+  }
+
+  Expr *base = e;
+  if (SliceExpr *slice = dynamic_cast<SliceExpr *>(e)) {
+    base = slice->get_base();
+  }
+
+  DeclRefExpr *d = dynamic_cast<DeclRefExpr *>(base);
+  VarDecl *vd = d ? dynamic_cast<VarDecl *>(sema->top_scope->get_decl(d->get_ident())) : nullptr;
+  if (vd && vd->is_mut() && dynamic_cast<const VecType *>(vd->get_type())) {
+    panic("slice of mutable vector may dangle once it grows: " + vd->get_name(), e->get_meta());
+  }
+}
+
+
+/// Checks that an argument of a spawned call does not borrow from the spawning function. The task may outlive the
+/// function, along with the arrays and vectors its slices point into and the mapped files it unmaps on return.
+static void check_spawn_arg(const Type *expected, Expr *arg) {
+  if (dynamic_cast<const SliceType *>(expected)) {
+    panic("slice passed to spawned call may outlive the storage it borrows", arg->get_meta());
+  } else if (dynamic_cast<const MappedFileType *>(expected)) {
+    panic("MappedFile passed to spawned call may be unmapped while the task reads it", arg->get_meta());
+  }
+}
+
+
+/// Checks that a mapped file is not copied. Each handle owns its mapping and unmaps it when it goes out of scope, so
+/// handles are only made by calls, and parameters borrow them for the length of a call.
+static void check_file_copy(const Type *expected, Expr *e) {
+  if (dynamic_cast<const MappedFileType *>(expected) && !dynamic_cast<CallExpr *>(e) && \
+      !dynamic_cast<MemberCallExpr *>(e)) {
+    panic("MappedFile cannot be copied, only initialized by a call", e->get_meta());
+  }
+}
+
+
+/// Checks that a call passes the given number of arguments to a builtin method.
+static void check_num_args(MemberCallExpr *e, int n) {
+  if (e->get_num_args() != n) {
+    panic("function " + e->get_callee() + " has " + std::to_string(n) + " parameters but " + \
+    std::to_string(e->get_num_args()) + " were provided.", e->get_meta());
+  }
+}
+
+
+/// Checks that an argument of a builtin method may be passed as the given type.
+static void check_arg(MemberCallExpr *e, int pos, const Type *T) {
+  if (!types_match(T, e->get_arg(pos)->get_type())) {
+    panic("type mismatch in " + e->get_callee() + " argument", e->get_arg(pos)->get_meta());
+  }
+  check_conversion(T, e->get_arg(pos));
+}
+
+
+/// Checks that the argument of a builtin algorithm names a function which may be used as a predicate on values
+/// of the given type. Predicates are passed by name, so each call is specialized for its predicate.
+static void check_predicate(MemberCallExpr *e, const Type *T) {
+  DeclRefExpr *ref = dynamic_cast<DeclRefExpr *>(e->get_arg(0));
+  FunctionDecl *fn = ref ? dynamic_cast<FunctionDecl *>(sema->pkg_scope->get_decl(ref->get_ident())) : nullptr;
+  if (!fn) {
+    panic("expected predicate function in " + e->get_callee(), e->get_arg(0)->get_meta());
+  }
+
+  const Type *ret_t = fn->get_type();
+  if (fn->is_async() || fn->get_num_params() != 1 || !ret_t || !ret_t->is_bool() || \
+      resolve_real_type(fn->get_params().at(0)->get_type(), sema->pkg_scope)->to_string() != T->to_string()) {
+    panic("predicate " + fn->get_name() + " must be a function from " + T->to_string() + " to bool", \
+      e->get_arg(0)->get_meta());
+  }
+}
+
+
+/// Checks a builtin algorithm call on an array, slice or vector with the given element type, and returns its
+/// result type.
+///
+/// Numeric sequences support the reductions `sum`, `min` and `max`, and `scan`, which replaces each element by
+/// the sum of it and all before it. `min`, `max` and `sort` also work on chars. `filter` returns a vector of the
+/// elements matching a predicate, and `partition` moves them to the front and returns how many there are. Only
+/// mutable arrays and vectors may be sorted, scanned or partitioned in place.
+static const Type *check_slice_method(MemberCallExpr *e, const Type *T) {
+  const std::string method = e->get_callee();
+  const PrimitiveType *pt = dynamic_cast<const PrimitiveType *>(T);
+  const bool is_numeric = pt && ((pt->is_integer() && !pt->is_bool()) || pt->is_float());
+  const bool is_ordered = is_numeric || (pt && pt->is_char());
+
+  if (method == "sum" || method == "min" || method == "max" || method == "sort" || method == "scan") {
+    check_num_args(e, 0);
+    if (!(method == "min" || method == "max" || method == "sort" ? is_ordered : is_numeric)) {
+      panic("function " + method + " on elements of type " + T->to_string(), e->get_meta());
+    }
+  } else if (method == "filter" || method == "partition") {
+    check_num_args(e, 1);
+    check_predicate(e, T);
+  } else {
+    panic("unresolved method on " + e->get_base()->get_type()->to_string() + ": " + method, e->get_meta());
+  }
+
+  if (method == "sort" || method == "scan" || method == "partition") {
+    if (dynamic_cast<const SliceType *>(e->get_base()->get_type())) {
+      panic("function " + method + " on read-only slice", e->get_meta());
+    }
+    check_mut_receiver(e);
+  }
+
+  if (method == "sort" || method == "scan") {
+    return nullptr;
+  } else if (method == "partition") {
+    return u64_type;
+  } else if (method == "filter") {
+    return get_vec_type(T);
+  }
+  return T;
+}
+
+
+/// Checks a builtin method call on a vector, and returns its result type.
+///
+/// Vectors support `push`, `pop`, `reserve` and `clear`, besides `len`, indexing, slicing and the builtin
+/// algorithms on slices.
+static const Type *check_vec_method(MemberCallExpr *e, const VecType *vt) {
+  const std::string method = e->get_callee();
+  const Type *T = resolve_real_type(vt->get_type(), sema->pkg_scope);
+
+  if (method == "push") {
+    check_num_args(e, 1);
+    check_arg(e, 0, T);
+  } else if (method == "reserve") {
+    check_num_args(e, 1);
+    check_arg(e, 0, u64_type);
+  } else if (method == "pop" || method == "clear") {
+    check_num_args(e, 0);
+  } else {
+    return check_slice_method(e, T);
+  }
+
+  check_mut_receiver(e);
+  return method == "pop" ? T : nullptr;
+}
+
+
+/// Checks a builtin method call on a map, and returns its result type.
+///
+/// Maps support `insert`, `get`, `contains`, `remove`, `clear` and `len`. Getting a missing key is a runtime
+/// error, so lookups of keys which may be missing go through `contains` first.
+static const Type *check_map_method(MemberCallExpr *e, const MapType *mt) {
+  const std::string method = e->get_callee();
+  const Type *K = resolve_real_type(mt->get_key_type(), sema->pkg_scope);
+  const Type *V = resolve_real_type(mt->get_value_type(), sema->pkg_scope);
+
+  if (method == "insert") {
+    check_num_args(e, 2);
+    check_arg(e, 0, K);
+    check_arg(e, 1, V);
+    check_mut_receiver(e);
+    return nullptr;
+  } else if (method == "get" || method == "contains" || method == "remove") {
+    check_num_args(e, 1);
+    check_arg(e, 0, K);
+    if (method == "remove") {
+      check_mut_receiver(e);
+    }
+    return method == "get" ? V : bool_type;
+  } else if (method == "clear") {
+    check_num_args(e, 0);
+    check_mut_receiver(e);
+    return nullptr;
+  } else if (method == "len") {
+    check_num_args(e, 0);
+    return u64_type;
+  }
+  panic("unresolved method on " + mt->to_string() + ": " + method, e->get_meta());
+  return nullptr;
+}
+
+
+/// Checks a builtin method call on a mapped file, and returns its result type.
+///
+/// Mapped files expose their contents through `bytes`, and `len`, and are read in chunks by `line`, which returns
+/// the line starting at a byte offset without its newline, and `record`, which returns the fixed-size record at an
+/// index. `advise` passes an `Advice` hint for the access pattern to the kernel, and `is_mapped` tells whether the
+/// file was mapped or read into a buffer. A file which could not be opened is empty, `ok` returns `false` for it,
+/// and `error` returns the `errno` it failed with, or 0.
+static const Type *check_file_method(MemberCallExpr *e) {
+  const std::string method = e->get_callee();
+  if (method == "bytes" || method == "len" || method == "is_mapped" || method == "ok" || method == "error") {
+    check_num_args(e, 0);
+  } else if (method == "line") {
+    check_num_args(e, 1);
+    check_arg(e, 0, u64_type);
+  } else if (method == "record") {
+    check_num_args(e, 2);
+    check_arg(e, 0, u64_type);
+    check_arg(e, 1, u64_type);
+  } else if (method == "advise") {
+    check_num_args(e, 1);
+    get_builtin_variant(e->get_arg(0), "Advice");
+  } else {
+    panic("unresolved method on MappedFile: " + method, e->get_meta());
+  }
+
+  if (method == "len") {
+    return u64_type;
+  } else if (method == "error") {
+    return i32_type;
+  } else if (method == "is_mapped" || method == "ok") {
+    return bool_type;
+  } else if (method == "advise") {
+    return nullptr;
+  }
+  return get_slice_type(u8_type);
+}
+
+
+/// Returns true if the given binary operator may be used as a parallel reduction.
+static bool is_reduction_op(BinaryOp op) {
+  return op == BinaryOp::AddAssign || op == BinaryOp::SubAssign || op == BinaryOp::StarAssign;
+}
+
+/// Checks that an element assigned through an index expression, or one of its fields, may be written.
+static void check_index_lvalue(IndexExpr *lhs, BinaryExpr *e) {
+  // only elements of mutable arrays and vectors may be assigned, slices and strings are read-only views
+  DeclRefExpr *d = dynamic_cast<DeclRefExpr *>(lhs->get_base());
+  VarDecl *vd = d ? dynamic_cast<VarDecl *>(sema->top_scope->get_decl(d->get_ident())) : nullptr;
+  if (!vd || (!dynamic_cast<const ArrayType *>(vd->get_type()) && !dynamic_cast<const VecType *>(vd->get_type()))) {
+    panic("assignment through index of non-array", e->get_meta());
+  }
+
+  if (!vd->is_mut()) {
+    panic("attempted to reassign immutable variable", e->get_meta());
+  }
+
+  // parallel loops may only write captured arrays at their own induction variable, so writes are disjoint
+  for (ParLoopFrame &frame : sema->par_frames) {
+    DeclRefExpr *index = dynamic_cast<DeclRefExpr *>(lhs->get_index());
+    if (!is_captured(vd, frame.loop)) {
+      continue;
+    } else if (!index || sema->top_scope->get_decl(index->get_ident()) != frame.loop->get_var()) {
+      panic("data race on captured array in parallel loop: " + vd->get_name(), e->get_meta());
+    }
+    frame.array_writes.insert({ vd, e->get_meta() });
+  }
+}
+
+
+PassVisitor::PassVisitor() : state(std::make_unique<SemaState>()) {}
+
+
+PassVisitor::~PassVisitor() = default;
+
 
 /// This check verifies that a crate unit is valid. It checks that all packages
 /// are unique and that the entry function 'main' exists.
 void PassVisitor::visit(CrateUnit *u) {
+  const SemaScope scope(state.get());
   for (PackageUnit *pkg : u->get_packages()) {
     // check the package name is not duplicated
-    for (PackageUnit *p : pkgs) {
+    for (PackageUnit *p : sema->pkgs) {
       if (p->get_name() == pkg->get_name()) {
         panic("duplicate package: " + pkg->get_name());
       }
     }
 
-    pkgs.push_back(pkg);
+    sema->pkgs.push_back(pkg);
   }
 
   for (PackageUnit *pkg : u->get_packages()) {
-    pkg_scope = pkg->get_scope();
+    sema->pkg_scope = pkg->get_scope();
     pkg->pass(this);
   }
-  pkg_scope = nullptr;
+  sema->pkg_scope = nullptr;
 
-  if (!has_entry) {
+  if (!sema->has_entry) {
     panic("no entry function 'main' found");
   }
+  lint_false_sharing();
+}
+
+
+/// This pass runs over the whole crate once every package is checked, so calls
+/// are followed across packages. Functions and methods which the entry function
+/// never reaches are removed. Trait implementations are kept whole, since a trait
+/// must be implemented in full, and so are what they call. Functions called from
+/// a single site, which are not async and do not call themselves, are marked to
+/// be inlined into that site.
+void PassVisitor::link(CrateUnit *u) {
+  const SemaScope scope(state.get());
+  std::vector<FunctionDecl *> reachable = {};
+  for (PackageUnit *pkg : u->get_packages()) {
+    for (Decl *d : pkg->get_decls()) {
+      FunctionDecl *fn_d = dynamic_cast<FunctionDecl *>(d);
+      ImplDecl *impl_d = dynamic_cast<ImplDecl *>(d);
+      if (fn_d && fn_d->is_main()) {
+        reachable.push_back(fn_d);
+      } else if (impl_d && impl_d->is_trait()) {
+        const std::vector<FunctionDecl *> methods = impl_d->get_methods();
+        reachable.insert(reachable.end(), methods.begin(), methods.end());
+      }
+    }
+  }
+
+  // walk the call graph from the entry function, counting call sites
+  std::map<FunctionDecl *, unsigned int> call_sites = {};
+  for (std::size_t i = 0; i < reachable.size(); i++) {
+    if (sema->call_graph.find(reachable[i]) == sema->call_graph.end()) {
+      continue;
+    }
+
+    for (FunctionDecl *callee : sema->call_graph.at(reachable[i])) {
+      call_sites[callee]++;
+      if (std::find(reachable.begin(), reachable.end(), callee) == reachable.end()) {
+        reachable.push_back(callee);
+      }
+    }
+  }
+
+  for (FunctionDecl *fn_d : reachable) {
+    const std::vector<FunctionDecl *> callees = sema->call_graph[fn_d];
+    const bool recursive = std::find(callees.begin(), callees.end(), fn_d) != callees.end();
+    if (call_sites[fn_d] == 1 && !fn_d->is_async() && !recursive) {
+      fn_d->set_inline();
+    }
+  }
+
+  // remove unreachable functions and methods, and their names from every scope
+  for (PackageUnit *pkg : u->get_packages()) {
+    for (Decl *d : pkg->get_decls()) {
+      if (FunctionDecl *fn_d = dynamic_cast<FunctionDecl *>(d)) {
+        if (std::find(reachable.begin(), reachable.end(), fn_d) != reachable.end()) {
+          continue;
+        }
+
+        for (PackageUnit *p : u->get_packages()) {
+          p->get_scope()->del_decl(fn_d);
+        }
+        pkg->remove_decl(d);
+      } else if (ImplDecl *impl_d = dynamic_cast<ImplDecl *>(d)) {
+        StructDecl *struct_d = dynamic_cast<StructDecl *>(pkg->get_scope()->get_decl(impl_d->get_struct_name()));
+        for (FunctionDecl *method : impl_d->get_methods()) {
+          if (std::find(reachable.begin(), reachable.end(), method) != reachable.end()) {
+            continue;
+          }
+
+          if (struct_d) {
+            struct_d->get_scope()->del_decl(method);
+          }
+          impl_d->remove_method(method);
+        }
+      }
+    }
+  }
 }
 
 
@@ -56,7 +1483,7 @@ void PassVisitor::visit(PackageUnit *u) {
     }
 
     bool found = false;
-    for (const PackageUnit *pkg : pkgs) {
+    for (const PackageUnit *pkg : sema->pkgs) {
       if (pkg->get_name() == import) {
         found = true;
       }
@@ -76,7 +1503,7 @@ void PassVisitor::visit(PackageUnit *u) {
   // TODO: check for duplicate decls
   for (const std::string &import : imports) {
     // get the pkg scope tree
-    for (PackageUnit *pkg : pkgs) {
+    for (PackageUnit *pkg : sema->pkgs) {
       if (pkg->get_name() == import) {
         for (Decl *decl : pkg->get_decls()) {
           if (decl->is_priv()) {
@@ -115,17 +1542,31 @@ void PassVisitor::visit(FunctionDecl *d) {
       panic("entry function 'main' must return void", d->get_meta());
     }
 
-    has_entry = true;
+    sema->has_entry = true;
   }
 
   // check that each param type exists in this scope
-  top_scope = d->get_scope();
+  sema->top_scope = d->get_scope();
   for (ParamVarDecl *param : d->get_params()) {
     param->pass(this);
   }
+
+  // reset the state machine bookkeeping for async functions
+  sema->curr_fn = d;
+  sema->await_epoch = 0;
+  sema->decl_epochs.clear();
+  for (ParamVarDecl *param : d->get_params()) {
+    sema->decl_epochs[param] = 0;
+  }
   
   // check that a valid return type exists
-  if (d->get_type() && !d->get_type()->is_builtin()) {
+  if (is_composite(d->get_type())) {
+    const Type *T = resolve_composite_type(d->get_type(), sema->pkg_scope);
+    if (!T) {
+      panic("unresolved return type: " + d->get_type()->to_string(), d->get_meta());
+    }
+    d->set_type(T);
+  } else if (d->get_type() && !d->get_type()->is_builtin()) {
     const TypeRef *T = dynamic_cast<const TypeRef *>(d->get_type());
     if (!T) {
       panic("unresolved return type: " + d->get_name(), d->get_meta());
@@ -142,12 +1583,17 @@ void PassVisitor::visit(FunctionDecl *d) {
     }
   }
 
-  fn_ret_type = d->get_type();
+  sema->fn_ret_type = d->get_type();
   if (Stmt *s = d->get_body()) {
     s->pass(this);
   }
-  fn_ret_type = nullptr;
-  top_scope = nullptr;
+
+  if (d->is_async()) {
+    d->set_suspend_points(sema->await_epoch);
+  }
+  sema->fn_ret_type = nullptr;
+  sema->top_scope = nullptr;
+  sema->curr_fn = nullptr;
 }
 
 
@@ -157,13 +1603,24 @@ void PassVisitor::visit(ParamVarDecl *d) {
     return;
   }
 
-  // type is a reference
-  if (const TypeRef *T = dynamic_cast<const TypeRef *>(d->get_type())) {
-    if (!top_scope) {
-      panic("scoping error: " + d->get_name(), d->get_meta());
+  // parameter types are resolved in the scope of their function, which may belong to another package than the call
+  if (!sema->top_scope) {
+    panic("scoping error: " + d->get_name(), d->get_meta());
+  }
+
+  // composite types are resolved by their element types
+  if (is_composite(d->get_type())) {
+    const Type *T = resolve_composite_type(d->get_type(), sema->top_scope);
+    if (!T) {
+      panic("unresolved parameter type: " + d->get_type()->to_string(), d->get_meta());
     }
+    d->set_type(T);
+    return;
+  }
 
-    StructDecl *struct_d = dynamic_cast<StructDecl *>(top_scope->get_decl(T->get_ident()));
+  // type is a reference
+  if (const TypeRef *T = dynamic_cast<const TypeRef *>(d->get_type())) {
+    StructDecl *struct_d = dynamic_cast<StructDecl *>(sema->top_scope->get_decl(T->get_ident()));
     if (!struct_d) {
       panic("unresolved parameter type: " + T->get_ident(), d->get_meta());
     }
@@ -181,11 +1638,12 @@ void PassVisitor::visit(ParamVarDecl *d) {
 /// This check facilitaties the verification of struct declarations.
 void PassVisitor::visit(StructDecl *d) {
   // check that each field type exists in this scope
-  top_scope = d->get_scope();
+  sema->top_scope = d->get_scope();
   for (FieldDecl *field : d->get_fields()) {
     field->pass(this);
   }
-  top_scope = nullptr;
+  sema->top_scope = nullptr;
+  layout_struct(d);
 }
 
 
@@ -195,13 +1653,23 @@ void PassVisitor::visit(FieldDecl *d) {
     return;
   }
 
+  // composite types are resolved by their element types
+  if (is_composite(d->get_type())) {
+    const Type *T = resolve_composite_type(d->get_type(), sema->pkg_scope);
+    if (!T) {
+      panic("unresolved field type: " + d->get_type()->to_string(), d->get_meta());
+    }
+    d->set_type(T);
+    return;
+  }
+
   // type is a reference
   if (const TypeRef *T = dynamic_cast<const TypeRef *>(d->get_type())) {
-    if (!top_scope) {
+    if (!sema->top_scope) {
       panic("scoping error: " + d->get_name(), d->get_meta());
     }
 
-    StructDecl *struct_d = dynamic_cast<StructDecl *>(top_scope->get_decl(T->get_ident()));
+    StructDecl *struct_d = dynamic_cast<StructDecl *>(sema->top_scope->get_decl(T->get_ident()));
     if (!struct_d) {
       panic("unresolved field type: " + T->get_ident(), d->get_meta());
     }
@@ -230,7 +1698,7 @@ void PassVisitor::visit(TraitDecl *d) {
 /// implemented to the target struct.
 void PassVisitor::visit(ImplDecl *d) {
   // check that the target struct exists
-  NamedDecl *decl = pkg_scope->get_decl(d->get_struct_name());
+  NamedDecl *decl = sema->pkg_scope->get_decl(d->get_struct_name());
   if (!decl) {
     panic("unresolved decl: " + d->get_struct_name(), d->get_meta());
   }
@@ -241,7 +1709,7 @@ void PassVisitor::visit(ImplDecl *d) {
   
   if (d->is_trait()) {
     // check that the trait exists
-    Decl *gen_d = pkg_scope->get_decl(d->trait());
+    Decl *gen_d = sema->pkg_scope->get_decl(d->trait());
     if (!gen_d) {
       panic("unresolved trait: " + d->trait(), d->get_meta());
     }
@@ -272,11 +1740,11 @@ void PassVisitor::visit(ImplDecl *d) {
     struct_d->get_scope()->add_decl(fn);
   }
 
-  impl_scope = struct_d->get_scope();
+  sema->impl_scope = struct_d->get_scope();
   for (FunctionDecl *fn : d->get_methods()) {
     fn->pass(this);
   }
-  impl_scope = nullptr;
+  sema->impl_scope = nullptr;
 }
 
 
@@ -301,21 +1769,54 @@ void PassVisitor::visit(VarDecl *d) {
   if (d->has_expr()) {
     d->get_expr()->pass(this);
   }
+
+  if (in_async_fn()) {
+    sema->decl_epochs[d] = sema->await_epoch;
+  }
   
+  // composite types are resolved by their element types, and task handles must be initialized by a spawn
+  if (is_composite(d->get_type())) {
+    const Type *T = resolve_composite_type(d->get_type(), sema->pkg_scope);
+    if (!T) {
+      panic("unresolved variable type: " + d->get_type()->to_string(), d->get_meta());
+    }
+    d->set_type(T);
+
+    if (!d->has_expr() && dynamic_cast<const TaskType *>(T)) {
+      panic("uninitialized task handle: " + d->get_name(), d->get_meta());
+    }
+
+    // atomics are initialized by a plain value of the type they hold
+    const Type *init_t = d->get_type();
+    if (const AtomicType *atomic_t = dynamic_cast<const AtomicType *>(T)) {
+      init_t = atomic_t->get_type();
+    }
+
+    if (d->has_expr()) {
+      if (!types_match(init_t, d->get_expr()->get_type())) {
+        panic("type mismatch: " + d->get_name(), d->get_meta());
+      }
+      check_conversion(init_t, d->get_expr().get());
+      check_vec_borrow(init_t, d->get_expr().get());
+      check_file_copy(init_t, d->get_expr().get());
+    }
+    return;
+  }
+
   if (!d->get_type()->is_builtin()) {
     // type is a reference
     if (const TypeRef *T = dynamic_cast<const TypeRef *>(d->get_type())) {
-      if (!top_scope) {
+      if (!sema->top_scope) {
         panic("scoping error: " + d->get_name(), d->get_meta());
       }
 
-      if (StructDecl *struct_d = dynamic_cast<StructDecl *>(top_scope->get_decl(T->get_ident()))) {
+      if (StructDecl *struct_d = dynamic_cast<StructDecl *>(sema->top_scope->get_decl(T->get_ident()))) {
         // assign real type
         if (struct_d->get_type()) {
           d->set_type(struct_d->get_type());
           return;
         }
-      } else if (EnumDecl *enum_d = dynamic_cast<EnumDecl *>(top_scope->get_decl(T->get_ident()))){
+      } else if (EnumDecl *enum_d = dynamic_cast<EnumDecl *>(sema->top_scope->get_decl(T->get_ident()))){
         // assign real type
         if (enum_d->get_type()) {
           d->set_type(enum_d->get_type());
@@ -329,13 +1830,23 @@ void PassVisitor::visit(VarDecl *d) {
     } 
   }
 
+  if (dynamic_cast<const VectorType *>(d->get_type())) {
+    if (d->has_expr() && !types_match(d->get_type(), d->get_expr()->get_type())) {
+      panic("type mismatch: " + d->get_name(), d->get_meta());
+    }
+    return;
+  }
+
   const PrimitiveType *pt = dynamic_cast<const PrimitiveType *>(d->get_type());
   if (!pt) {
     panic("unresolved variable type in scope: " + d->get_name(), d->get_meta());
   }
 
-  if (!pt->compare(d->get_expr()->get_type())) {
-    panic("type mismatch: " + d->get_name(), d->get_meta());
+  if (d->has_expr()) {
+    if (!pt->compare(d->get_expr()->get_type())) {
+      panic("type mismatch: " + d->get_name(), d->get_meta());
+    }
+    check_conversion(pt, d->get_expr().get());
   }
 }
 
@@ -350,11 +1861,11 @@ void PassVisitor::visit(DeclStmt *s) {
 /// This check verifies that a compound statement is valid. It passes on all
 /// statements within the compound statement.
 void PassVisitor::visit(CompoundStmt *s) {
-  top_scope = s->get_scope();
+  sema->top_scope = s->get_scope();
   for (Stmt *stmt : s->get_stmts()) {
     stmt->pass(this);
   }
-  top_scope = top_scope->get_parent();
+  sema->top_scope = sema->top_scope->get_parent();
 }
 
 
@@ -362,15 +1873,18 @@ void PassVisitor::visit(CompoundStmt *s) {
 /// condition is evaluable to a boolean, and that both the then and else
 /// bodies are valid.
 void PassVisitor::visit(IfStmt *s) {
-  if (!s->get_cond()->get_type()->is_bool_evaluable()) {
+  // the condition is typed by this pass, so it is checked after it, which also rejects vector masks
+  s->get_cond()->pass(this);
+  if (!s->get_cond()->get_type() || !s->get_cond()->get_type()->is_bool_evaluable()) {
     panic("non-boolean condition in if statement", s->get_meta());
   }
 
-  s->get_cond()->pass(this);
+  sema->cond_depth++;
   s->get_then_body()->pass(this);
   if (s->has_else()) {
     s->get_else_body()->pass(this);
   }
+  sema->cond_depth--;
 }
 
 
@@ -378,7 +1892,9 @@ void PassVisitor::visit(IfStmt *s) {
 /// match expression and the match case.
 void PassVisitor::visit(MatchCase *s) {
   s->get_expr()->pass(this);
+  sema->cond_depth++;
   s->get_body()->pass(this);
+  sema->cond_depth--;
 }
 
 
@@ -429,15 +1945,92 @@ void PassVisitor::visit(MatchStmt *s) {
 /// This check verifies that an until statement is valid. It checks that the
 /// condition is evaluable to a boolean, and that the body is valid.
 void PassVisitor::visit(UntilStmt *s) {
+  // the condition is re-evaluated on every iteration, so it belongs to the loop
+  enter_async_loop();
   s->get_cond()->pass(this);
 
   if (!s->get_cond()->get_type()->is_bool_evaluable()) {
     panic("non-boolean condition in until statement", s->get_meta());
   }
 
-  in_loop = true;
+  const bool prev_in_loop = sema->in_loop;
+  const bool prev_in_par_loop = sema->in_par_loop;
+  sema->in_loop = true;
+  sema->in_par_loop = false;
+  sema->cond_depth++;
+  sema->loop_frames.push_back({ nullptr, sema->cond_depth, false, {} });
+  s->get_body()->pass(this);
+  sema->loop_frames.pop_back();
+  sema->cond_depth--;
+  exit_async_loop();
+  sema->in_loop = prev_in_loop;
+  sema->in_par_loop = prev_in_par_loop;
+}
+
+
+/// This check verifies that a for statement is valid. It checks that the range
+/// bounds are integers, and assigns the induction variable its type. In a
+/// parallel for statement, it also checks that captured mutable variables are
+/// only written through reductions, and records those reductions.
+void PassVisitor::visit(ForStmt *s) {
+  s->get_lo()->pass(this);
+  s->get_hi()->pass(this);
+
+  const Type *lo_type = s->get_lo()->get_type();
+  const Type *hi_type = s->get_hi()->get_type();
+  if (!lo_type || !hi_type || !lo_type->is_integer() || !hi_type->is_integer()) {
+    panic("non-integer range in for statement", s->get_meta());
+  }
+
+  VarDecl *var = dynamic_cast<VarDecl *>(s->get_var());
+  if (!var) {
+    panic("expected induction variable in for statement", s->get_meta());
+  }
+  var->set_type(lo_type);
+  if (in_async_fn()) {
+    sema->decl_epochs[var] = sema->await_epoch;
+  }
+
+  const bool prev_in_loop = sema->in_loop;
+  const bool prev_in_par_loop = sema->in_par_loop;
+  sema->in_loop = true;
+  sema->in_par_loop = s->is_parallel();
+  if (s->is_parallel()) {
+    sema->par_frames.push_back(ParLoopFrame{ s });
+  }
+
+  // the body runs no times for an empty range, so it is conditional to enclosing loops
+  std::shared_ptr<Scope> prev_scope = sema->top_scope;
+  sema->top_scope = s->get_scope();
+  sema->cond_depth++;
+  sema->loop_frames.push_back({ s, sema->cond_depth, false, {} });
+  enter_async_loop();
   s->get_body()->pass(this);
-  in_loop = false;
+  exit_async_loop();
+  finish_bounds(sema->loop_frames.back());
+  sema->loop_frames.pop_back();
+  sema->cond_depth--;
+  sema->top_scope = prev_scope;
+
+  if (s->is_parallel()) {
+    // check that no reduced variable is also read elsewhere in the loop
+    const ParLoopFrame &frame = sema->par_frames.back();
+    for (const std::pair<VarDecl *const, unsigned int> &reduce : frame.reduces) {
+      if (frame.reads.at(reduce.first) > reduce.second) {
+        panic("captured variable read while being reduced in parallel loop: " + reduce.first->get_name(), s->get_meta());
+      }
+    }
+
+    // elements written by one iteration may only be read by the same iteration
+    for (const std::pair<VarDecl *, Metadata> &read : frame.array_reads) {
+      if (frame.array_writes.find(read.first) != frame.array_writes.end()) {
+        panic("data race on captured array in parallel loop: " + read.first->get_name(), read.second);
+      }
+    }
+    sema->par_frames.pop_back();
+  }
+  sema->in_loop = prev_in_loop;
+  sema->in_par_loop = prev_in_par_loop;
 }
 
 
@@ -445,41 +2038,58 @@ void PassVisitor::visit(UntilStmt *s) {
 /// expression, if it exists, is equivelant to the return type of the function.
 void PassVisitor::visit(ReturnStmt *s) {
   // check that the return stmt is in a function scope
-  if (!top_scope) {
+  if (!sema->top_scope) {
     panic("return statement outside of function scope", s->get_meta());
   }
 
-  if (!s->get_expr() && !fn_ret_type) {
+  if (!sema->par_frames.empty()) {
+    panic("return statement in parallel loop", s->get_meta());
+  }
+
+  for (LoopFrame &frame : sema->loop_frames) {
+    frame.exits = true;
+  }
+
+  if (!s->get_expr() && !sema->fn_ret_type) {
     return;
-  } else if (s->get_expr() && !fn_ret_type) {
+  } else if (s->get_expr() && !sema->fn_ret_type) {
     panic("return statement in void function", s->get_meta());
   }
 
   s->get_expr()->pass(this);
-  if (fn_ret_type->is_builtin()) {
-    const PrimitiveType *pt = dynamic_cast<const PrimitiveType *>(fn_ret_type);
-    if (!pt->compare(s->get_expr()->get_type())) {
-      panic("type mismatch in return statement", s->get_meta());
-    }
-  } else if (s->get_expr()->get_type() != fn_ret_type) {
+  if (!types_match(sema->fn_ret_type, s->get_expr()->get_type())) {
     panic("type mismatch in return statement", s->get_meta());
   }
+  check_conversion(sema->fn_ret_type, s->get_expr());
+  check_file_copy(sema->fn_ret_type, s->get_expr());
 }
 
 
 /// This check verifies that a break statement is in the scope of a loop.
 void PassVisitor::visit(BreakStmt *s) {
-  if (!in_loop) {
+  if (!sema->in_loop) {
     panic("break statement outside of loop scope");
   }
+
+  if (sema->in_par_loop) {
+    panic("break statement in parallel loop", s->get_meta());
+  }
+  sema->loop_frames.back().exits = true;
 }
 
 
 /// This check verifies that a continue statement is in the scope of a loop.
 void PassVisitor::visit(ContinueStmt *s) {
-  if (!in_loop) {
+  if (!sema->in_loop) {
     panic("continue statement outside of loop scope");
   }
+
+  if (sema->in_par_loop) {
+    panic("continue statement in parallel loop", s->get_meta());
+  }
+
+  // the rest of the body is skipped for this iteration
+  sema->loop_frames.back().exits = true;
 }
 
 
@@ -512,6 +2122,11 @@ void PassVisitor::visit(IntegerLiteral *e) {
   if (!e->get_type()->is_integer()) {
     panic("non-integer type in integer literal", e->get_meta());
   }
+
+  const PrimitiveType *pt = dynamic_cast<const PrimitiveType *>(e->get_type());
+  if (e->is_suffixed() && !literal_fits(e, pt)) {
+    panic("integer literal out of range for type " + pt->to_string(), e->get_meta());
+  }
 }
 
 
@@ -533,8 +2148,8 @@ void PassVisitor::visit(CharLiteral *e) {
 
 /// This check verifies that a StringLiteral node is a string primitive.
 void PassVisitor::visit(StringLiteral *e) {
-  if (!e->get_type()->is_builtin()) {
-    panic("non-primitive type in string literal", e->get_meta());
+  if (!e->get_type()->is_str()) {
+    panic("non-string type in string literal", e->get_meta());
   }
 }
 
@@ -542,20 +2157,67 @@ void PassVisitor::visit(StringLiteral *e) {
 /// This check verifies that a DeclRefExpr node is valid. It assigns the real
 /// type of the declaration reference, assuming the node is valid.
 void PassVisitor::visit(DeclRefExpr *e) {
-  if (!e->get_type()->is_builtin()) {
+  // locals referenced after an await since their declaration live in the async frame
+  if (in_async_fn() && !e->is_nested()) {
+    NamedDecl *d = sema->top_scope->get_decl(e->get_ident());
+    if (d && sema->decl_epochs.find(d) != sema->decl_epochs.end()) {
+      if (sema->decl_epochs.at(d) < sema->await_epoch) {
+        sema->curr_fn->add_frame_decl(d);
+      }
+
+      for (AsyncLoopFrame &loop : sema->async_loops) {
+        loop.refs.push_back(d);
+      }
+    }
+  }
+
+  // count reads of captured mutable variables in parallel loops
+  if (!sema->par_frames.empty() && !e->is_nested()) {
+    VarDecl *vd = dynamic_cast<VarDecl *>(sema->top_scope->get_decl(e->get_ident()));
+    for (ParLoopFrame &frame : sema->par_frames) {
+      if (vd && vd->is_mut() && is_captured(vd, frame.loop)) {
+        frame.reads[vd]++;
+      }
+    }
+  }
+
+  // functions are only referenced by name as the predicates of builtin algorithms
+  if (!e->get_type() && !e->is_nested()) {
+    if (FunctionDecl *fn_d = dynamic_cast<FunctionDecl *>(sema->pkg_scope->get_decl(e->get_ident()))) {
+      if (e != sema->predicate_arg) {
+        panic("function used as value: " + e->get_ident(), e->get_meta());
+      }
+      add_call(fn_d);
+      return;
+    }
+  }
+
+  if (!e->get_type()) {
+    panic("unresolved reference: " + e->get_ident(), e->get_meta());
+  }
+
+  if (is_composite(e->get_type())) {
+    e->set_type(resolve_composite_type(e->get_type(), sema->pkg_scope));
+  } else if (const EnumType *et = dynamic_cast<const EnumType *>(e->get_type());
+             et && BUILTIN_ENUMS.find(et->get_name()) != BUILTIN_ENUMS.end()) {
+    const std::vector<std::string> &variants = BUILTIN_ENUMS.at(et->get_name());
+    if (!e->is_nested() || std::find(variants.begin(), variants.end(), e->get_ident()) == variants.end()) {
+      panic("unresolved " + et->get_name() + " variant: " + e->get_ident(), e->get_meta());
+    }
+  } else if (!e->get_type()->is_builtin()) {
     const TypeRef *T = dynamic_cast<const TypeRef *>(e->get_type());
     if (!T) {
       panic("unresolved type reference: " + e->get_ident(), e->get_meta());
     }
 
-    TypeDecl *type_d = dynamic_cast<TypeDecl *>(top_scope->get_decl(T->get_ident()));
+    TypeDecl *type_d = dynamic_cast<TypeDecl *>(sema->top_scope->get_decl(T->get_ident()));
     if (type_d->get_type()->is_struct()) {
-      StructDecl *struct_d = dynamic_cast<StructDecl *>(top_scope->get_decl(T->get_ident()));
+      StructDecl *struct_d = dynamic_cast<StructDecl *>(sema->top_scope->get_decl(T->get_ident()));
       if (!struct_d) {
         panic("unresolved struct type reference: " + T->get_ident(), e->get_meta());
       }
     } else if (type_d->get_type()->is_enum()) {
-      EnumDecl *enum_d = dynamic_cast<EnumDecl *>(top_scope->get_decl(T->get_ident()));
+      EnumDecl *enum_d = dynamic_cast<EnumDecl *>(sema->top_scope->get_decl(T->get_ident()));
       if (!enum_d) {
         panic("unresolved enum type reference: " + T->get_ident(), e->get_meta());
       }
@@ -590,36 +2252,105 @@ void PassVisitor::visit(DeclRefExpr *e) {
 /// types match. It also checks that the left hand side is a valid lvalue if
 /// the operator is an assignment operator.
 void PassVisitor::visit(BinaryExpr *e) {
+  // the right hand side of a short-circuiting operator is conditional
+  const bool short_circuits = e->get_op() == BinaryOp::LogicAnd || e->get_op() == BinaryOp::LogicOr;
   e->get_lhs()->pass(this);
+  sema->cond_depth += short_circuits;
   e->get_rhs()->pass(this);
+  sema->cond_depth -= short_circuits;
+
+  // atomics are only accessed through their builtin methods, so every access names its ordering
+  if (dynamic_cast<const AtomicType *>(e->get_lhs()->get_type()) || \
+      dynamic_cast<const AtomicType *>(e->get_rhs()->get_type())) {
+    panic(std::string("non-atomic ") + (is_assignment_op(e->get_op()) ? "store to" : "access of") + \
+      " atomic in binary expression, use its builtin methods", e->get_meta());
+  }
 
-  if (e->get_lhs()->get_type()->is_builtin() && e->get_rhs()->get_type()->is_builtin()) {
+  const bool is_vector = dynamic_cast<const VectorType *>(e->get_lhs()->get_type()) || \
+    dynamic_cast<const VectorType *>(e->get_rhs()->get_type());
+  const Type *result = e->get_lhs()->get_type();
+  if (is_vector) {
+    e->set_type(check_vector_binary(e));
+  } else if (e->get_lhs()->get_type()->is_builtin() && e->get_rhs()->get_type()->is_builtin()) {
     const PrimitiveType *pt_lhs = dynamic_cast<const PrimitiveType *>(e->get_lhs()->get_type());
     const PrimitiveType *pt_rhs = dynamic_cast<const PrimitiveType *>(e->get_rhs()->get_type());
     if (!pt_lhs->compare(pt_rhs)) {
       panic("built-in type mismatch in binary expression", e->get_meta());
-    }    
-  } else if (e->get_lhs()->get_type() != e->get_rhs()->get_type()) {
+    }
+
+    // strings only support (in)equality and assignment
+    if (pt_lhs->is_str() && e->get_op() != BinaryOp::IsEq && e->get_op() != BinaryOp::IsNotEq \
+      && e->get_op() != BinaryOp::Assign) {
+      panic("unsupported operator on str in binary expression", e->get_meta());
+    }
+
+    // adaptable operands take on the type of the other operand, and otherwise the wider operand wins
+    if (is_assignment_op(e->get_op()) || is_adaptable(e->get_rhs())) {
+      check_conversion(pt_lhs, e->get_rhs());
+    } else if (is_adaptable(e->get_lhs())) {
+      check_conversion(pt_rhs, e->get_lhs());
+      result = pt_rhs;
+    } else if (pt_rhs->get_bits() > pt_lhs->get_bits()) {
+      result = pt_rhs;
+    }
+  } else if (!types_match(e->get_lhs()->get_type(), e->get_rhs()->get_type())) {
     if (!e->get_lhs()->get_type()->is_integer() || !e->get_rhs()->get_type()->is_integer()) {
       panic("type mismatch in binary expression", e->get_meta());
     }
+  } else if (is_assignment_op(e->get_op())) {
+    check_conversion(e->get_lhs()->get_type(), e->get_rhs());
   }
 
-  e->set_type(e->get_lhs()->get_type());
+  // comparisons keep their boolean type from the parser
+  if (!is_vector && !is_comparison_op(e->get_op())) {
+    e->set_type(result);
+  }
 
   if (is_assignment_op(e->get_op())) {
+    check_vec_borrow(e->get_lhs()->get_type(), e->get_rhs());
+    if (dynamic_cast<const MappedFileType *>(e->get_lhs()->get_type())) {
+      panic("MappedFile cannot be reassigned", e->get_meta());
+    }
+
     // check that the left hand side is a valid lvalue
     if (DeclRefExpr *lhs = dynamic_cast<DeclRefExpr *>(e->get_lhs())) {
       // check that the left hand side is mutable
-      if (VarDecl *vd = dynamic_cast<VarDecl *>(top_scope->get_decl(lhs->get_ident()))) {
+      if (VarDecl *vd = dynamic_cast<VarDecl *>(sema->top_scope->get_decl(lhs->get_ident()))) {
         if (!vd->is_mut()) {
           panic("attempted to reassign immutable variable", e->get_meta());
         }
+
+        // captured variables may only be written through reductions in parallel loops
+        for (ParLoopFrame &frame : sema->par_frames) {
+          if (!is_captured(vd, frame.loop)) {
+            continue;
+          }
+
+          if (!is_reduction_op(e->get_op())) {
+            panic("data race on captured variable in parallel loop: " + vd->get_name(), e->get_meta());
+          }
+
+          if (frame.ops.find(vd) != frame.ops.end() && frame.ops.at(vd) != e->get_op()) {
+            panic("conflicting reductions on captured variable in parallel loop: " + vd->get_name(), e->get_meta());
+          }
+
+          frame.ops[vd] = e->get_op();
+          frame.reduces[vd]++;
+          frame.loop->add_reduction(e);
+        }
       }
     } else if (MemberExpr *lhs = dynamic_cast<MemberExpr *>(e->get_lhs())) {
+      // fields of array elements are checked like the elements themselves
+      Expr *base = lhs->get_base();
+      while (MemberExpr *member = dynamic_cast<MemberExpr *>(base)) {
+        base = member->get_base();
+      }
+
       // check that the left hand side base is mutable
-      if (DeclRefExpr *d = dynamic_cast<DeclRefExpr *>(lhs->get_base())) {
-        Decl *gd = top_scope->get_decl(d->get_ident());
+      if (IndexExpr *index = dynamic_cast<IndexExpr *>(base)) {
+        check_index_lvalue(index, e);
+      } else if (DeclRefExpr *d = dynamic_cast<DeclRefExpr *>(base)) {
+        Decl *gd = sema->top_scope->get_decl(d->get_ident());
         if (!gd) {
           panic("unresolved reference: " + d->get_ident(), d->get_meta());
         }
@@ -632,7 +2363,15 @@ void PassVisitor::visit(BinaryExpr *e) {
         if (!vd->is_mut()) {
           panic("attempted to reassign immutable variable", e->get_meta());
         }
+
+        for (ParLoopFrame &frame : sema->par_frames) {
+          if (is_captured(vd, frame.loop)) {
+            panic("data race on captured variable in parallel loop: " + vd->get_name(), e->get_meta());
+          }
+        }
       }
+    } else if (IndexExpr *lhs = dynamic_cast<IndexExpr *>(e->get_lhs())) {
+      check_index_lvalue(lhs, e);
     } else {
       panic("assignment to non-lvalue", e->get_meta());
     }
@@ -646,7 +2385,15 @@ void PassVisitor::visit(UnaryExpr *e) {
   e->get_expr()->pass(this);
   e->set_type(e->get_expr()->get_type());
 
-  if (e->is_bang() && !e->get_expr()->get_type()->is_bool()) {
+  // references produce runes, and runes are dereferenced to the type they point to
+  if (e->is_ref() && e->get_expr()->get_type()) {
+    e->set_type(get_rune_type(e->get_expr()->get_type()));
+  } else if (const RuneType *rune_t = dynamic_cast<const RuneType *>(e->get_expr()->get_type()); rune_t && e->is_rune()) {
+    e->set_type(resolve_real_type(rune_t->get_type(), sema->pkg_scope));
+  }
+
+  const VectorType *vt = dynamic_cast<const VectorType *>(e->get_expr()->get_type());
+  if (e->is_bang() && !e->get_expr()->get_type()->is_bool() && !(vt && vt->is_mask())) {
     panic("non-boolean type in bang expression", e->get_meta());
   }
 }
@@ -657,7 +2404,7 @@ void PassVisitor::visit(UnaryExpr *e) {
 /// their types correspond.
 void PassVisitor::visit(InitExpr *e) {
   // resolve target struct
-  StructDecl *d = dynamic_cast<StructDecl *>(pkg_scope->get_decl(e->get_ident()));
+  StructDecl *d = dynamic_cast<StructDecl *>(sema->pkg_scope->get_decl(e->get_ident()));
   if (!d) {
     panic("unresolved struct: " + e->get_ident());
   }
@@ -681,6 +2428,11 @@ void PassVisitor::visit(InitExpr *e) {
       panic("unknown field: " + f.first);
     }
 
+    // atomic fields are initialized by a plain value of the type they hold
+    if (const AtomicType *atomic_t = dynamic_cast<const AtomicType *>(real_type)) {
+      real_type = resolve_real_type(atomic_t->get_type(), sema->pkg_scope);
+    }
+
     f.second->pass(this);
     // handle null initialization
     if (!f.second->get_type()) {
@@ -693,13 +2445,14 @@ void PassVisitor::visit(InitExpr *e) {
     }
 
     if (f.second->get_type()->is_builtin()) {
-      const PrimitiveType *pt = dynamic_cast<const PrimitiveType *>(f.second->get_type());
-      if (!pt->compare(real_type)) {
+      if (!types_match(real_type, f.second->get_type())) {
         panic("built-in type mismatch in struct initialization: " + f.first, f.second->get_meta());
       }
+      check_conversion(real_type, f.second);
     } else if (f.second->get_type() != real_type) {
       panic("source defined type mismatch in struct initialization: " + f.first, f.second->get_meta());
     }
+    check_file_copy(real_type, f.second);
   }
 
   // implicitly state uninitialized fields as null
@@ -729,7 +2482,26 @@ void PassVisitor::visit(InitExpr *e) {
 void PassVisitor::visit(CallExpr *e) {
   // resolve function
   const std::string fn_name = e->get_callee();
-  Decl *d = pkg_scope->get_decl(fn_name);
+  Decl *d = sema->pkg_scope->get_decl(fn_name);
+
+  // files are opened by the builtin `map_file`, unless a function of the package shadows it
+  if (!d && fn_name == "map_file") {
+    if (e == sema->awaited_call) {
+      panic("await on non-async function call: " + fn_name, e->get_meta());
+    }
+
+    if (e->get_num_args() != 1) {
+      panic("function map_file has 1 parameters but " + std::to_string(e->get_num_args()) + " were provided.", e->get_meta());
+    }
+    e->get_arg(0)->pass(this);
+
+    if (!types_match(str_type, e->get_arg(0)->get_type())) {
+      panic("type mismatch in function call: path", e->get_arg(0)->get_meta());
+    }
+    e->set_type(mapped_file_type);
+    return;
+  }
+
   if (!d) {
     panic("unresolved function: " + fn_name);
   }
@@ -738,6 +2510,13 @@ void PassVisitor::visit(CallExpr *e) {
   if (!fn_d) {
     panic("expected function: " + fn_name);
   }
+  add_call(fn_d);
+
+  if (fn_d->is_async() && e != sema->awaited_call && e != sema->spawned_call) {
+    panic("async function call must be awaited: " + fn_name, e->get_meta());
+  } else if (!fn_d->is_async() && e == sema->awaited_call) {
+    panic("await on non-async function call: " + fn_name, e->get_meta());
+  }
 
   if (e->get_num_args() != fn_d->get_num_params()) {
     panic("function " + fn_name + " has " + std::to_string(fn_d->get_num_params()) + " parameters but " + \
@@ -748,21 +2527,24 @@ void PassVisitor::visit(CallExpr *e) {
   if (fn_d->has_params()) {
     std::size_t pos = 0;
     for (ParamVarDecl *param : fn_d->get_params()) {
+      std::shared_ptr<Scope> prev_scope = sema->top_scope;
+      sema->top_scope = fn_d->get_scope();
       param->pass(this);
+      sema->top_scope = prev_scope;
+
       Expr *arg = e->get_arg(pos);
       if (!arg) {
         panic("missing argument in function call: " + param->get_name());
       }
       arg->pass(this);
 
-      if (param->get_type()->is_builtin()) {
-        const PrimitiveType *pt = dynamic_cast<const PrimitiveType *>(param->get_type());
-        if (!pt->compare(arg->get_type())) {
-          panic("type mismatch in function call: " + param->get_name());
-        }
-      } else if (param->get_type() != arg->get_type()) {
+      if (!types_match(param->get_type(), arg->get_type())) {
         panic("type mismatch in function call: " + param->get_name());
       }
+      check_conversion(param->get_type(), arg);
+      if (e == sema->spawned_call) {
+        check_spawn_arg(param->get_type(), arg);
+      }
 
       pos += 1;
     }
@@ -771,7 +2553,7 @@ void PassVisitor::visit(CallExpr *e) {
   // check if the function return is a type reference
   if (const TypeRef *T = dynamic_cast<const TypeRef *>(fn_d->get_type())) {
     // check if the referenced type exists
-    StructDecl *struct_d = dynamic_cast<StructDecl *>(pkg_scope->get_decl(T->get_ident()));
+    StructDecl *struct_d = dynamic_cast<StructDecl *>(sema->pkg_scope->get_decl(T->get_ident()));
     if (!struct_d) {
       panic("unresolved return type: " + T->get_ident());
     }
@@ -810,7 +2592,7 @@ void PassVisitor::visit(MemberExpr *e) {
 
   // resolve generic struct declaration from package scope
   const std::string struct_name = st->get_name();
-  Decl *d = pkg_scope->get_decl(struct_name);
+  Decl *d = sema->pkg_scope->get_decl(struct_name);
   if (!d) {
     panic("unresolved declaration type: " + struct_name, e->get_meta());
   }
@@ -828,10 +2610,28 @@ void PassVisitor::visit(MemberExpr *e) {
   }
 
   // access level check
-  if (fd->is_priv() && impl_scope != struct_d->get_scope()) {
+  if (fd->is_priv() && sema->impl_scope != struct_d->get_scope()) {
     panic("attempted to access private field: " + e->get_member(), e->get_meta());
   }
 
+  // fields of elements of struct-of-arrays storage are read from the column of the field
+  if (IndexExpr *index = dynamic_cast<IndexExpr *>(e->get_base()); index && struct_d->is_soa()) {
+    const Type *container = index->get_base()->get_type();
+    if (dynamic_cast<const ArrayType *>(container) || dynamic_cast<const VecType *>(container)) {
+      e->set_soa();
+
+      // loops indexing by their induction variable walk the column of the field
+      DeclRefExpr *base = dynamic_cast<DeclRefExpr *>(index->get_base());
+      DeclRefExpr *var = dynamic_cast<DeclRefExpr *>(index->get_index());
+      for (auto it = sema->loop_frames.rbegin(); base && var && it != sema->loop_frames.rend(); it++) {
+        if (it->loop && it->loop->get_var() == sema->top_scope->get_decl(var->get_ident())) {
+          it->loop->add_column(base->get_ident() + "." + e->get_member());
+          break;
+        }
+      }
+    }
+  }
+
   // assign real type
   e->set_type(fd->get_type());
 }
@@ -848,10 +2648,88 @@ void PassVisitor::visit(MemberCallExpr *e) {
 
   // resolve base type
   const Type *base_type = e->get_base()->get_type();
+  sema->predicate_arg = (e->get_callee() == "filter" || e->get_callee() == "partition") && e->get_num_args() > 0 ? \
+    e->get_arg(0) : nullptr;
+  if (get_element_type(base_type) && e->get_callee() == "len") {
+    if (e->get_num_args() != 0) {
+      panic("function len has 0 parameters but " + std::to_string(e->get_num_args()) + " were provided.", e->get_meta());
+    }
+
+    e->set_type(u64_type);
+    return;
+  }
+
+  // arrays and slices only have the builtin algorithms
+  if (dynamic_cast<const ArrayType *>(base_type) || dynamic_cast<const SliceType *>(base_type)) {
+    for (int i = 0; i < e->get_num_args(); i++) {
+      e->get_arg(i)->pass(this);
+    }
+
+    if (e == sema->awaited_call) {
+      panic("await on non-async method call: " + e->get_callee(), e->get_meta());
+    }
+
+    e->set_type(check_slice_method(e, get_element_type(base_type)));
+    return;
+  }
+
+  // vectors, atomics, channels, collections and mapped files only have builtin methods
+  const VectorType *vt = dynamic_cast<const VectorType *>(base_type);
+  const AtomicType *atomic_t = dynamic_cast<const AtomicType *>(base_type);
+  const ChanType *chan_t = dynamic_cast<const ChanType *>(base_type);
+  const VecType *vec_t = dynamic_cast<const VecType *>(base_type);
+  const MapType *map_t = dynamic_cast<const MapType *>(base_type);
+  const MappedFileType *file_t = dynamic_cast<const MappedFileType *>(base_type);
+  if (vt || atomic_t || chan_t || vec_t || map_t || file_t) {
+    for (int i = 0; i < e->get_num_args(); i++) {
+      e->get_arg(i)->pass(this);
+    }
+
+    if (e == sema->awaited_call) {
+      panic("await on non-async method call: " + e->get_callee(), e->get_meta());
+    }
+
+    if (vt) {
+      e->set_type(check_vector_method(e, vt));
+    } else if (atomic_t) {
+      e->set_type(check_atomic_method(e, atomic_t));
+      if (e->get_callee() != "load") {
+        add_atomic_write(e);
+      }
+    } else if (chan_t) {
+      e->set_type(check_chan_method(e, chan_t));
+    } else if (vec_t) {
+      e->set_type(check_vec_method(e, vec_t));
+    } else if (map_t) {
+      e->set_type(check_map_method(e, map_t));
+    } else {
+      e->set_type(check_file_method(e));
+    }
+    return;
+  }
+
   if (base_type->is_builtin()) {
     panic("member access on non-struct type", e->get_meta());
   }
 
+  // task handles only have the builtin `join` method
+  if (const TaskType *task_t = dynamic_cast<const TaskType *>(base_type)) {
+    if (e->get_callee() != "join") {
+      panic("unresolved method on task handle: " + e->get_callee(), e->get_meta());
+    }
+
+    if (e->get_num_args() != 0) {
+      panic("function join has 0 parameters but " + std::to_string(e->get_num_args()) + " were provided.", e->get_meta());
+    }
+
+    if (e == sema->awaited_call) {
+      panic("await on non-async method call: join", e->get_meta());
+    }
+
+    e->set_type(resolve_real_type(task_t->get_type(), sema->pkg_scope));
+    return;
+  }
+
   // resolve struct type from base type
   const StructType *st = dynamic_cast<const StructType *>(base_type);
   if (!st) {
@@ -860,7 +2738,7 @@ void PassVisitor::visit(MemberCallExpr *e) {
 
   // resolve generic struct declaration from package scope
   const std::string struct_name = st->get_name();
-  Decl *d = pkg_scope->get_decl(struct_name);
+  Decl *d = sema->pkg_scope->get_decl(struct_name);
   if (!d) {
     panic("unresolved declaration type: " + struct_name, e->get_meta());
   }
@@ -882,12 +2760,19 @@ void PassVisitor::visit(MemberCallExpr *e) {
   if (!method_decl) {
     panic("expected function: " + e->get_callee());
   }
+  add_call(method_decl);
 
   // access level check
-  if (method_decl->is_priv() && impl_scope != struct_d->get_scope()) {
+  if (method_decl->is_priv() && sema->impl_scope != struct_d->get_scope()) {
     panic("attempted to access private method: " + e->get_callee(), e->get_meta());
   }
 
+  if (method_decl->is_async() && e != sema->awaited_call && e != sema->spawned_call) {
+    panic("async method call must be awaited: " + e->get_callee(), e->get_meta());
+  } else if (!method_decl->is_async() && e == sema->awaited_call) {
+    panic("await on non-async method call: " + e->get_callee(), e->get_meta());
+  }
+
   // param count check
   if (e->get_num_args() != method_decl->get_num_params()) {
     panic("function " + e->get_callee() + " has " + std::to_string(method_decl->get_num_params()) + " parameters but " + \
@@ -898,21 +2783,24 @@ void PassVisitor::visit(MemberCallExpr *e) {
   if (method_decl->has_params()) {
     std::size_t pos = 0;
     for (ParamVarDecl *param : method_decl->get_params()) {
+      std::shared_ptr<Scope> prev_scope = sema->top_scope;
+      sema->top_scope = method_decl->get_scope();
       param->pass(this);
+      sema->top_scope = prev_scope;
+
       Expr *arg = e->get_arg(pos);
       if (!arg) {
         panic("missing argument in function call: " + param->get_name());
       }
       arg->pass(this);
 
-      if (param->get_type()->is_builtin()) {
-        const PrimitiveType *pt = dynamic_cast<const PrimitiveType *>(param->get_type());
-        if (!pt->compare(arg->get_type())) {
-          panic("type mismatch in function call: " + param->get_name());
-        }
-      } else if (param->get_type() != arg->get_type()) {
+      if (!types_match(param->get_type(), arg->get_type())) {
         panic("type mismatch in function call: " + param->get_name());
       }
+      check_conversion(param->get_type(), arg);
+      if (e == sema->spawned_call) {
+        check_spawn_arg(param->get_type(), arg);
+      }
 
       pos += 1;
     }
@@ -921,7 +2809,7 @@ void PassVisitor::visit(MemberCallExpr *e) {
   // check if the function return is a type reference
   if (const TypeRef *T = dynamic_cast<const TypeRef *>(method_decl->get_type())) {
     // check if the referenced type exists
-    StructDecl *struct_d = dynamic_cast<StructDecl *>(pkg_scope->get_decl(T->get_ident()));
+    StructDecl *struct_d = dynamic_cast<StructDecl *>(sema->pkg_scope->get_decl(T->get_ident()));
     if (!struct_d) {
       panic("unresolved return type: " + T->get_ident());
     }
@@ -941,7 +2829,7 @@ void PassVisitor::visit(MemberCallExpr *e) {
 
 /// This check resolves the real type of a this expression.
 void PassVisitor::visit(ThisExpr *e) {
-  if (!top_scope) {
+  if (!sema->top_scope) {
     panic("this expression outside of struct scope", e->get_meta());
   }
 
@@ -950,7 +2838,7 @@ void PassVisitor::visit(ThisExpr *e) {
     panic("unresolved 'this' type", e->get_meta());
   }
 
-  StructDecl *struct_d = dynamic_cast<StructDecl *>(top_scope->get_decl(RT->get_ident()));
+  StructDecl *struct_d = dynamic_cast<StructDecl *>(sema->top_scope->get_decl(RT->get_ident()));
   if (!struct_d) {
     panic("unresolved 'this' type", e->get_meta());
   }
@@ -959,3 +2847,264 @@ void PassVisitor::visit(ThisExpr *e) {
     e->set_type(struct_d->get_type());
   }
 }
+
+
+/// This check verifies that an await expression is valid. It checks that it
+/// appears in an async function outside of parallel loops, and that it awaits
+/// a call to an async function. Each await is assigned the next state of the
+/// enclosing function's state machine.
+void PassVisitor::visit(AwaitExpr *e) {
+  if (!in_async_fn()) {
+    panic("await outside of async function", e->get_meta());
+  }
+
+  if (!sema->par_frames.empty()) {
+    panic("await in parallel loop", e->get_meta());
+  }
+
+  const Expr *prev_awaited = sema->awaited_call;
+  sema->awaited_call = e->get_expr();
+  e->get_expr()->pass(this);
+  sema->awaited_call = prev_awaited;
+
+  e->set_type(e->get_expr()->get_type());
+  e->set_state(++sema->await_epoch);
+}
+
+
+/// This check verifies that a spawn expression is valid. It checks that it
+/// spawns a function call outside of parallel loops, and assigns it the type of
+/// a task handle over the result of the call.
+void PassVisitor::visit(SpawnExpr *e) {
+  if (!sema->par_frames.empty()) {
+    panic("spawn in parallel loop", e->get_meta());
+  }
+
+  const Expr *prev_spawned = sema->spawned_call;
+  sema->spawned_call = e->get_expr();
+  e->get_expr()->pass(this);
+  sema->spawned_call = prev_spawned;
+
+  e->set_type(get_task_type(e->get_expr()->get_type()));
+}
+
+
+/// This check verifies that a vector construction is valid. It checks that
+/// each lane value is compatible with the lane type of the vector.
+void PassVisitor::visit(VectorExpr *e) {
+  const VectorType *vt = dynamic_cast<const VectorType *>(e->get_type());
+  for (std::size_t i = 0; i < e->get_num_lanes(); i++) {
+    Expr *lane = e->get_lane(i);
+    lane->pass(this);
+
+    if (!vt->get_elem()->compare(lane->get_type())) {
+      panic("type mismatch in vector construction: " + vt->to_string(), lane->get_meta());
+    }
+    check_conversion(vt->get_elem(), lane);
+  }
+}
+
+
+/// This check verifies that a cast expression is valid. Casts may convert
+/// between integer, floating point, character and boolean values, but may not
+/// produce a boolean or convert strings.
+void PassVisitor::visit(CastExpr *e) {
+  e->get_expr()->pass(this);
+
+  const PrimitiveType *from = dynamic_cast<const PrimitiveType *>(e->get_expr()->get_type());
+  const PrimitiveType *to = dynamic_cast<const PrimitiveType *>(e->get_type());
+  if (!from || !to) {
+    panic("cast between non-primitive types", e->get_meta());
+  }
+
+  if (from->is_str() || to->is_str()) {
+    panic("cast to or from str", e->get_meta());
+  }
+
+  if (to->is_bool() && !from->is_bool()) {
+    panic("cast to bool, compare against zero instead", e->get_meta());
+  }
+
+  if (to->is_char() && !from->is_char() && from->get_kind() != PrimitiveType::__UINT8) {
+    panic("cast to char from type other than u8", e->get_meta());
+  }
+}
+
+
+/// This check verifies that an array literal is valid. The element type is
+/// that of the first element with a fixed type, and all other elements must
+/// convert to it.
+void PassVisitor::visit(ArrayExpr *e) {
+  for (std::size_t i = 0; i < e->get_num_elements(); i++) {
+    e->get_element(i)->pass(this);
+  }
+
+  Expr *first = e->get_element(0);
+  for (std::size_t i = 0; i < e->get_num_elements(); i++) {
+    if (!is_adaptable(e->get_element(i))) {
+      first = e->get_element(i);
+      break;
+    }
+  }
+
+  const Type *T = first->get_type();
+  if (!T) {
+    panic("array of void", e->get_meta());
+  }
+
+  for (std::size_t i = 0; i < e->get_num_elements(); i++) {
+    Expr *element = e->get_element(i);
+    if (!types_match(T, element->get_type())) {
+      panic("type mismatch in array literal", element->get_meta());
+    }
+    check_conversion(T, element);
+  }
+  e->set_type(get_array_type(T, e->get_num_elements()));
+}
+
+
+/// Returns the type of the first expression of a literal with a fixed type, or of the first one if all adapt.
+static const Type *get_literal_type(const std::vector<Expr *> &exprs) {
+  for (Expr *expr : exprs) {
+    if (!is_adaptable(expr)) {
+      return expr->get_type();
+    }
+  }
+  return exprs.front()->get_type();
+}
+
+
+/// This check verifies that a map literal is valid. Its key and value types
+/// are found like the element type of an array literal, and keys must be
+/// hashable.
+void PassVisitor::visit(MapExpr *e) {
+  std::vector<Expr *> keys;
+  std::vector<Expr *> values;
+  for (std::size_t i = 0; i < e->get_num_entries(); i++) {
+    e->get_key(i)->pass(this);
+    e->get_value(i)->pass(this);
+    keys.push_back(e->get_key(i));
+    values.push_back(e->get_value(i));
+  }
+
+  const Type *K = get_literal_type(keys);
+  const Type *V = get_literal_type(values);
+  if (!K || !V) {
+    panic("map of void", e->get_meta());
+  } else if (!is_hashable(K)) {
+    panic("unhashable map key type: " + K->to_string(), e->get_meta());
+  }
+
+  for (std::size_t i = 0; i < e->get_num_entries(); i++) {
+    if (!types_match(K, keys[i]->get_type()) || !types_match(V, values[i]->get_type())) {
+      panic("type mismatch in map literal", keys[i]->get_meta());
+    }
+    check_conversion(K, keys[i]);
+    check_conversion(V, values[i]);
+  }
+  e->set_type(get_map_type(K, V));
+}
+
+
+/// This check verifies that an index expression is valid. It checks that the
+/// base is an array, slice or string and that the index is an integer, and
+/// decides how the bounds of the index are checked.
+void PassVisitor::visit(IndexExpr *e) {
+  e->get_base()->pass(this);
+  e->get_index()->pass(this);
+
+  const Type *T = get_element_type(e->get_base()->get_type());
+  if (!T) {
+    panic("index into non-indexable type", e->get_meta());
+  }
+
+  const Type *index_t = e->get_index()->get_type();
+  if (!index_t || !index_t->is_integer() || index_t->is_bool()) {
+    panic("non-integer index", e->get_index()->get_meta());
+  }
+  // indices of any sign are checked at run time, so only literals are converted
+  if (is_adaptable(e->get_index())) {
+    check_conversion(u64_type, e->get_index());
+  }
+
+  e->set_type(T);
+  e->set_bounds(check_bounds(e));
+
+  // reads of captured mutable arrays in parallel loops are races if another iteration may write the element
+  DeclRefExpr *base = dynamic_cast<DeclRefExpr *>(e->get_base());
+  VarDecl *vd = base ? dynamic_cast<VarDecl *>(sema->top_scope->get_decl(base->get_ident())) : nullptr;
+  DeclRefExpr *index = dynamic_cast<DeclRefExpr *>(e->get_index());
+  for (ParLoopFrame &frame : sema->par_frames) {
+    if (vd && vd->is_mut() && is_captured(vd, frame.loop) && \
+        (!index || sema->top_scope->get_decl(index->get_ident()) != frame.loop->get_var())) {
+      frame.array_reads.push_back({ vd, e->get_meta() });
+    }
+  }
+}
+
+
+/// This check verifies that a slice expression is valid. It checks that the
+/// base is an array, slice or string and that the bounds are integers, and
+/// that constant bounds are in range of arrays.
+void PassVisitor::visit(SliceExpr *e) {
+  e->get_base()->pass(this);
+
+  const Type *T = get_element_type(e->get_base()->get_type());
+  if (!T) {
+    panic("slice of non-indexable type", e->get_meta());
+  } else if (is_soa(T)) {
+    panic("slice of struct-of-arrays storage: " + e->get_base()->get_type()->to_string(), e->get_meta());
+  }
+
+  for (Expr *bound : { e->get_lo(), e->get_hi() }) {
+    if (!bound) {
+      continue;
+    }
+    bound->pass(this);
+
+    if (!bound->get_type() || !bound->get_type()->is_integer() || bound->get_type()->is_bool()) {
+      panic("non-integer bound in slice expression", bound->get_meta());
+    }
+    if (is_adaptable(bound)) {
+      check_conversion(u64_type, bound);
+    }
+  }
+
+  // constant bounds must be ordered and within arrays
+  IntegerLiteral *lo = dynamic_cast<IntegerLiteral *>(e->get_lo());
+  IntegerLiteral *hi = dynamic_cast<IntegerLiteral *>(e->get_hi());
+  if (lo && hi && lo->get_value() > hi->get_value()) {
+    panic("slice bounds out of order", e->get_meta());
+  }
+
+  if (const ArrayType *arr_t = dynamic_cast<const ArrayType *>(e->get_base()->get_type())) {
+    if ((lo && lo->get_value() > arr_t->get_len()) || (hi && hi->get_value() > arr_t->get_len())) {
+      panic("slice bounds out of range of " + arr_t->to_string(), e->get_meta());
+    }
+  }
+
+  e->set_type(get_slice_type(T));
+}
+
+
+/// This check verifies that a print expression is valid. It checks that each
+/// argument is a primitive value, and that it suits the specifier of its
+/// placeholder, which selects the routine it is emitted by.
+void PassVisitor::visit(PrintExpr *e) {
+  for (int i = 0; i < e->get_num_args(); i++) {
+    Expr *arg = e->get_arg(i);
+    arg->pass(this);
+
+    const PrimitiveType *pt = dynamic_cast<const PrimitiveType *>(arg->get_type());
+    if (!pt) {
+      panic("unprintable type in print: " + (arg->get_type() ? arg->get_type()->to_string() : "void"), arg->get_meta());
+    }
+
+    const std::string spec = e->get_specs().at(i);
+    if (spec == "x" && (!pt->is_integer() || pt->is_bool())) {
+      panic("format specifier {:x} on non-integer type " + pt->to_string(), arg->get_meta());
+    } else if (!spec.empty() && spec != "x" && !pt->is_float()) {
+      panic("format specifier {:" + spec + "} on non-float type " + pt->to_string(), arg->get_meta());
+    }
+  }
+}
@@ -1,7 +1,17 @@
+#include <algorithm>
 #include <filesystem>
 #include <iostream>
+#include <set>
+#include <stdexcept>
+#include <unistd.h>
 
 #include "include/ast/Builder.h"
+#include "include/core/Cache.h"
+#include "include/core/Loader.h"
+#include "include/core/Lsp.h"
+#include "include/core/Manifest.h"
+#include "include/core/Server.h"
+#include "include/core/Watch.h"
 #include "include/token/Token.h"
 #include "include/core/ASTContext.h"
 #include "include/ast/Unit.h"
@@ -23,22 +33,28 @@ static void print_tkstream(std::unique_ptr<ASTContext> &Cctx) {
 /// Parse command line arguments.
 static void parse_args(int argc, char *argv[], CFlags &flags) {
   flags.emit_asm = false;
-  
+  flags.lto = false;
+  flags.cache = true;
+
   for (int i = 1; i < argc; i++) {
     if (std::string(argv[i]) == "-S") {
       flags.emit_asm = true;
     } else if (std::string(argv[i]) == "-P1") {
       flags.pass_one = true;
+    } else if (std::string(argv[i]) == "-flto") {
+      flags.lto = true;
+    } else if (std::string(argv[i]) == "--no-cache") {
+      flags.cache = false;
     }
   }
 }
 
 
 /// Parse the program source tree.
-static std::vector<CFile> parse_files(std::vector<CFile> files, std::filesystem::path dir) {
+static void parse_files(std::vector<CFile> &files, const std::filesystem::path &dir) {
   for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator{dir}) {
     if (entry.is_directory()) {
-      files = parse_files(files, entry.path());
+      parse_files(files, entry.path());
     }
 
     if (entry.is_regular_file() && entry.path().extension() == ".statim" ) {
@@ -48,26 +64,204 @@ static std::vector<CFile> parse_files(std::vector<CFile> files, std::filesystem:
       files.push_back(file);
     }
   }
+}
+
+
+/// Find the source files of the crate in a directory.
+///
+/// Crates with a manifest are made of the packages their entry package imports, and
+/// crates without one of every source file under the directory.
+static std::vector<CFile> find_files(const std::filesystem::path &dir) {
+  Manifest manifest;
+  if (load_manifest(dir, manifest)) {
+    return discover_files(manifest);
+  }
 
+  std::vector<CFile> files;
+  parse_files(files, dir);
   return files;
 }
 
 
-/// Main entry point for the compiler.
-int main(int argc, char *argv[]) {
+/// Run a `statimc cache` command, which reports on or prunes the build cache.
+static int run_cache_cmd(int argc, char *argv[]) {
+  const BuildCache cache;
+  const std::string cmd = argc > 2 ? argv[2] : "";
+  if (cmd == "stats") {
+    std::cout << "path: " << cache.get_dir().string() << '\n';
+    std::cout << "entries: " << cache.count() << '\n';
+    std::cout << "size: " << cache.size() << " bytes\n";
+    std::cout << "limit: " << cache.limit() << " bytes\n";
+    return 0;
+  } else if (cmd == "prune") {
+    // prune to the given size, or to the size limit
+    const std::string max_size = argc > 3 ? argv[3] : std::to_string(cache.limit());
+    if (max_size.empty() || max_size.find_first_not_of("0123456789") != std::string::npos) {
+      panic("expected a size in bytes after 'cache prune'");
+    }
+
+    std::uintmax_t max_bytes = 0;
+    try {
+      max_bytes = std::stoull(max_size);
+    } catch (const std::out_of_range &) {
+      panic("size out of range after 'cache prune': " + max_size);
+    }
+    std::cout << "removed " << cache.prune(max_bytes) << " entries\n";
+    return 0;
+  }
+  panic("expected 'stats' or 'prune' after 'cache'");
+}
+
+
+/// Load the output of every package of a crate from the build cache.
+/// @returns `true` if every package was cached.
+static bool load_cached(const std::vector<CFile> &files, const BuildCache &cache, std::string &result) {
+  // packages are parsed from the last file to the first, and printed in that order
+  for (auto file = files.rbegin(); file != files.rend(); file++) {
+    std::string unit;
+    if (!cache.load(remove_extension(file->filename), unit)) {
+      return false;
+    }
+    result += unit;
+  }
+  return true;
+}
+
+
+/// Answers a compile request from the build cache, if every package of its crate is cached.
+/// @returns The exit status of the request, or -1 if it needs to be compiled.
+static int serve_cached(const ServerRequest &req) {
+  std::vector<char *> argv;
+  for (const std::string &arg : req.args) {
+    argv.push_back(const_cast<char *>(arg.c_str()));
+  }
+
+  CFlags flags;
+  parse_args(argv.size(), argv.data(), flags);
+  std::vector<CFile> files = find_files(req.cwd);
+  if (!flags.cache || files.empty()) {
+    return -1;
+  }
+  load_sources(files);
+
+  BuildCache cache;
+  cache.add_packages(files, flags);
+
+  std::string result;
+  if (!load_cached(files, cache, result)) {
+    return -1;
+  }
+  return write(req.out, result.data(), result.size()) == static_cast<ssize_t>(result.size()) ? 0 : 1;
+}
+
+
+/// Serve a compile request in the compile server, if every package of its crate is cached.
+///
+/// Panics while finding the crate, like those of a malformed manifest, are collected rather than exiting the
+/// server, and the request is left for the forked compile to report them.
+/// @returns The exit status of the request, or -1 if it needs to be compiled.
+static int serve(const ServerRequest &req) {
+  std::vector<Diagnostic> diags;
+  diag_sink = &diags;
+  int status = -1;
+  try {
+    status = serve_cached(req);
+  } catch (const CompileError &) {
+    // reported by the forked compile
+  } catch (const std::exception &) {
+    // like a directory which cannot be read, also reported by the forked compile
+  }
+  diag_sink = nullptr;
+  return status;
+}
+
+
+/// Compile the crate in the current directory.
+static int compile(int argc, char *argv[]) {
   CFlags flags;
   parse_args(argc, argv, flags);
-  std::vector<CFile> files = parse_files(std::vector<CFile>(), std::filesystem::current_path());
+  std::vector<CFile> files = find_files(std::filesystem::current_path());
 
   if (files.size() == 0) {
     panic("no source files found in cwd: " + std::filesystem::current_path().string());
   }
+  load_sources(files);
+
+  // if every package is cached, nothing needs to be compiled
+  BuildCache cache;
+  if (flags.cache) {
+    cache.add_packages(files, flags);
+
+    std::string result;
+    if (load_cached(files, cache, result)) {
+      std::cout << result;
+      return 0;
+    }
+  }
+
+  // diagnostics are collected to learn which packages warned, since a hit skips sema and would lose their warnings
+  std::vector<Diagnostic> diags;
+  std::unique_ptr<CrateUnit> crate;
+  std::unique_ptr<PassVisitor> visitor;
+  diag_sink = &diags;
+  try {
+    std::unique_ptr<ASTContext> ctx = std::make_unique<ASTContext>(flags, std::move(files));
+    crate = build_ast(ctx);
+
+    // the visitor owns the types sema built, which the crate points to until it is printed
+    visitor = std::make_unique<PassVisitor>();
+    crate->pass(visitor.get());
+
+    if (flags.lto) {
+      visitor->link(crate.get());
+    }
+  } catch (const CompileError &) {
+    diag_sink = nullptr;
+    std::for_each(diags.begin(), diags.end(), print_diagnostic);
+    return 1;
+  }
+  diag_sink = nullptr;
+
+  std::set<std::string> warned;
+  for (const Diagnostic &diag : diags) {
+    print_diagnostic(diag);
+    warned.insert(remove_extension(diag.meta.filename));
+  }
 
-  std::unique_ptr<ASTContext> ctx = std::make_unique<ASTContext>(flags, std::move(files));
-  std::unique_ptr<CrateUnit> crate = build_ast(ctx);
+  const std::vector<std::string> units = crate->to_units();
+  const std::vector<PackageUnit *> pkgs = crate->get_packages();
+  for (std::size_t i = 0; i < units.size(); i++) {
+    std::cout << units[i];
+    if (flags.cache && warned.find(pkgs[i]->get_name()) == warned.end()) {
+      cache.store(pkgs[i]->get_name(), units[i]);
+    }
+  }
+  return 0;
+}
+
+
+/// Main entry point for the compiler.
+int main(int argc, char *argv[]) {
+  if (argc > 1 && std::string(argv[1]) == "cache") {
+    return run_cache_cmd(argc, argv);
+  } else if (argc > 1 && std::string(argv[1]) == "lsp") {
+    run_lsp(find_files);
+  }
 
-  std::unique_ptr<ASTVisitor> visitor = std::make_unique<PassVisitor>();
-  crate->pass(visitor.get());
+  for (int i = 1; i < argc; i++) {
+    if (std::string(argv[i]) == "--server") {
+      run_server(i + 1 < argc && argv[i + 1][0] != '-' ? argv[i + 1] : get_server_path(), serve, compile);
+    } else if (std::string(argv[i]) == "--watch") {
+      run_watch(compile, argc, argv);
+    }
+  }
 
-  std::cout << crate->to_string();
+  // with a compile server named, compiles are forwarded to it if it is running
+  if (std::getenv("STATIMC_SERVER")) {
+    int status = 0;
+    if (run_client(get_server_path(), argc, argv, status)) {
+      return status;
+    }
+  }
+  return compile(argc, argv);
 }